@@ -1,5 +1,6 @@
 #include <iostream>
 #include <string>
+#include <cmath>
 
 using namespace std;
 
@@ -39,10 +40,190 @@ Persona* crearPersona(int id, string nombre, string fecha) {
     return nueva;
 }
 
+// =============================================================================
+// ESTRUCTURA: ListaPersonas
+// DESCRIPCIN: Almacena un arreglo dinmico de punteros a nodos Persona.
+//              Crece duplicando su capacidad, sin lmite fijo de nodos.
+// =============================================================================
+struct ListaPersonas {
+    Persona** elementos;    // Arreglo dinmico de punteros a Persona
+    int cantidad;           // Nmero actual de elementos
+    int capacidad;          // Tamao reservado del arreglo
+};
+
+// =============================================================================
+// FUNCIN: inicializarLista
+// OBJETIVO: Inicializa una lista vaca reservando espacio inicial.
+// PARMETROS:
+//    - lista: Referencia a la lista a inicializar
+//    - capacidad: Nmero de elementos esperado (opcional, default=16)
+// =============================================================================
+void inicializarLista(ListaPersonas &lista, int capacidad = 16) {
+    if (capacidad < 1) capacidad = 1;
+    lista.elementos = new Persona*[capacidad];
+    lista.cantidad = 0;
+    lista.capacidad = capacidad;
+}
+
+// =============================================================================
+// FUNCIN: liberarLista
+// OBJETIVO: Libera la memoria del arreglo (no los nodos a los que apunta).
+// PARMETROS:
+//    - lista: Referencia a la lista a liberar
+// =============================================================================
+void liberarLista(ListaPersonas &lista) {
+    delete[] lista.elementos;
+    lista.elementos = NULL;
+    lista.cantidad = 0;
+    lista.capacidad = 0;
+}
+
+// =============================================================================
+// FUNCIN: agregarALista
+// OBJETIVO: Aade un puntero a Persona a la lista, amplindola si est llena.
+// PARMETROS:
+//    - lista: Referencia a la lista
+//    - p: Puntero al nodo Persona a agregar
+// =============================================================================
+void agregarALista(ListaPersonas &lista, Persona* p) {
+    if (lista.cantidad == lista.capacidad) {
+        Persona** nuevos = new Persona*[lista.capacidad * 2];
+        for (int i = 0; i < lista.cantidad; i++) {
+            nuevos[i] = lista.elementos[i];
+        }
+        delete[] lista.elementos;
+        lista.elementos = nuevos;
+        lista.capacidad *= 2;
+    }
+    lista.elementos[lista.cantidad++] = p;
+}
+
+// =============================================================================
+// FUNCIN: almacenarNodos
+// OBJETIVO: Almacena todos los nodos del rbol en una lista (recorrido inorden).
+// PARMETROS:
+//    - raiz: Puntero al nodo raz del rbol
+//    - lista: Referencia a la lista donde se almacenarn los nodos
+// =============================================================================
+void almacenarNodos(Persona* raiz, ListaPersonas &lista) {
+    if (raiz == NULL) return;
+    almacenarNodos(raiz->izq, lista);
+    agregarALista(lista, raiz);
+    almacenarNodos(raiz->der, lista);
+}
+
+// =============================================================================
+// FUNCIN: construirArbolBalanceado
+// OBJETIVO: Construye un rbol balanceado a partir de una lista ordenada.
+// PARMETROS:
+//    - lista: Lista de nodos ordenados
+//    - inicio: ndice de inicio del subarreglo
+//    - fin: ndice de fin del subarreglo
+// RETORNO: Puntero a la raz del nuevo subrbol balanceado.
+// =============================================================================
+Persona* construirArbolBalanceado(ListaPersonas &lista, int inicio, int fin) {
+    if (inicio > fin) return NULL;
+    
+    int medio = (inicio + fin) / 2;
+    Persona* raiz = lista.elementos[medio];
+    
+    raiz->izq = construirArbolBalanceado(lista, inicio, medio - 1);
+    raiz->der = construirArbolBalanceado(lista, medio + 1, fin);
+    
+    return raiz;
+}
+
+// =============================================================================
+// BALANCEO AUTOMTICO (rbol chivo expiatorio / scapegoat)
+// DESCRIPCIN: En lugar de reconstruir todo el rbol desde el men, insertar
+//              detecta cundo un nodo queda ms profundo de lo permitido y
+//              reconstruye solo el subrbol desbalanceado ms cercano. As el
+//              costo de rebalanceo se reparte entre muchas operaciones.
+//              Invariante: profundidad <= log_{1/ALFA}(maxNodos) + 1.
+// =============================================================================
+const double ALFA = 0.7;             // Un hijo puede tener hasta ALFA * tamao del padre
+const int MAX_PROFUNDIDAD = 128;     // Cota del camino de insercin (>> log_{1/ALFA}(2^31))
+
+int totalNodos = 0;                  // Nodos actualmente en el rbol
+int maxNodos = 0;                    // Mximo de nodos desde la ltima reconstruccin total
+long reconstrucciones = 0;           // Subrboles reconstruidos automticamente
+long nodosReconstruidos = 0;         // Nodos movidos por todas las reconstrucciones
+
+// =============================================================================
+// FUNCIN: tamano
+// OBJETIVO: Cuenta los nodos de un subrbol.
+// PARMETROS:
+//    - raiz: Puntero al nodo raz del subrbol
+// RETORNO: Nmero de nodos del subrbol.
+// =============================================================================
+int tamano(Persona* raiz) {
+    if (raiz == NULL) return 0;
+    return tamano(raiz->izq) + tamano(raiz->der) + 1;
+}
+
+// =============================================================================
+// FUNCIN: alturaArbol
+// OBJETIVO: Calcula la altura de un subrbol (nmero de niveles).
+// PARMETROS:
+//    - raiz: Puntero al nodo raz del subrbol
+// RETORNO: Altura del subrbol (0 si est vaco).
+// =============================================================================
+int alturaArbol(Persona* raiz) {
+    if (raiz == NULL) return 0;
+    int hi = alturaArbol(raiz->izq);
+    int hd = alturaArbol(raiz->der);
+    return (hi > hd ? hi : hd) + 1;
+}
+
+// =============================================================================
+// FUNCIN: profundidadPermitida
+// OBJETIVO: Devuelve la profundidad mxima aceptada para n nodos.
+// PARMETROS:
+//    - n: Nmero de nodos del rbol
+// RETORNO: floor(log_{1/ALFA}(n)).
+// =============================================================================
+int profundidadPermitida(int n) {
+    if (n < 2) return 0;
+    return (int)floor(log((double)n) / log(1.0 / ALFA));
+}
+
+// =============================================================================
+// FUNCIN: reconstruirSubarbol
+// OBJETIVO: Reemplaza un subrbol por uno perfectamente balanceado con los
+//           mismos nodos (se reutilizan, no se copian).
+// PARMETROS:
+//    - raiz: Referencia al enlace que apunta al subrbol
+//    - cantidad: Nmero de nodos del subrbol (para reservar la lista)
+// =============================================================================
+void reconstruirSubarbol(Persona* &raiz, int cantidad) {
+    ListaPersonas lista;
+    inicializarLista(lista, cantidad);
+    almacenarNodos(raiz, lista);
+    raiz = construirArbolBalanceado(lista, 0, lista.cantidad - 1);
+    reconstrucciones++;
+    nodosReconstruidos += lista.cantidad;
+    liberarLista(lista);
+}
+
+// =============================================================================
+// FUNCIN: balancearArbol
+// OBJETIVO: Reconstruye el rbol completo. Lo usa eliminar cuando el rbol
+//           se reduce por debajo de ALFA * maxNodos.
+// PARMETROS:
+//    - raiz: Referencia al puntero raz del rbol
+// =============================================================================
+void balancearArbol(Persona* &raiz) {
+    reconstruirSubarbol(raiz, totalNodos);
+    maxNodos = totalNodos;
+}
+
 // =============================================================================
 // FUNCIN: insertar
 // OBJETIVO: Inserta un nuevo nodo en el rbol binario de bsqueda (BST) segn el ID.
 //           Tambin establece los punteros al padre y madre si se proporcionan.
+//           Si el nuevo nodo queda demasiado profundo, busca hacia arriba el
+//           primer ancestro desbalanceado (chivo expiatorio) y reconstruye
+//           nicamente su subrbol.
 // PARMETROS:
 //    - raiz: Referencia al puntero raz del rbol/subrbol
 //    - id: Identificador nico del nuevo nodo
@@ -52,20 +233,43 @@ Persona* crearPersona(int id, string nombre, string fecha) {
 //    - madre: Puntero al nodo madre (opcional)
 // =============================================================================
 void insertar(Persona* &raiz, int id, string nombre, string fecha, Persona* padre, Persona* madre) {
-    if (raiz == NULL) {
-        raiz = crearPersona(id, nombre, fecha);
-        raiz->padre = padre;
-        raiz->madre = madre;
-        return;
+    Persona** camino[MAX_PROFUNDIDAD];
+    int profundidad = 0;
+    Persona** enlace = &raiz;
+    
+    while (*enlace != NULL) {
+        if (id == (*enlace)->id) return;
+        camino[profundidad++] = enlace;
+        enlace = (id < (*enlace)->id) ? &(*enlace)->izq : &(*enlace)->der;
     }
     
-    if (id < raiz->id) {
-        insertar(raiz->izq, id, nombre, fecha, padre, madre);
-    } else if (id > raiz->id) {
-        insertar(raiz->der, id, nombre, fecha, padre, madre);
+    Persona* nuevo = crearPersona(id, nombre, fecha);
+    nuevo->padre = padre;
+    nuevo->madre = madre;
+    *enlace = nuevo;
+    
+    totalNodos++;
+    if (totalNodos > maxNodos) maxNodos = totalNodos;
+    
+    if (profundidad <= profundidadPermitida(totalNodos)) return;
+    
+    // Subir desde el nodo nuevo hasta encontrar el chivo expiatorio:
+    // el primer ancestro cuyo hijo en el camino supera ALFA * su tamao.
+    Persona* hijo = nuevo;
+    int tamHijo = 1;
+    for (int i = profundidad - 1; i >= 0; i--) {
+        Persona* nodo = *camino[i];
+        Persona* hermano = (nodo->izq == hijo) ? nodo->der : nodo->izq;
+        int tamNodo = tamHijo + tamano(hermano) + 1;
+        
+        if (tamHijo > ALFA * tamNodo) {
+            reconstruirSubarbol(*camino[i], tamNodo);
+            return;
+        }
+        hijo = nodo;
+        tamHijo = tamNodo;
     }
 }
-
 // =============================================================================
 // FUNCIN: buscar
 // OBJETIVO: Busca un nodo en el rbol por su ID (recursivo).
@@ -101,29 +305,31 @@ Persona* encontrarMinimo(Persona* raiz) {
 }
 
 // =============================================================================
-// FUNCIN: eliminar
+// FUNCIN: eliminarNodo
 // OBJETIVO: Elimina un nodo del rbol por su ID (recursivo) y reestructura el rbol.
 // PARMETROS:
 //    - raiz: Puntero al nodo raz del rbol/subrbol
 //    - id: Identificador del nodo a eliminar
 // RETORNO: Puntero a la nueva raz del subrbol modificado.
 // =============================================================================
-Persona* eliminar(Persona* raiz, int id) {
+Persona* eliminarNodo(Persona* raiz, int id) {
     if (raiz == NULL) return raiz;
 
     if (id < raiz->id) {
-        raiz->izq = eliminar(raiz->izq, id);
+        raiz->izq = eliminarNodo(raiz->izq, id);
     } else if (id > raiz->id) {
-        raiz->der = eliminar(raiz->der, id);
+        raiz->der = eliminarNodo(raiz->der, id);
     } else {
         // Caso 1: Nodo sin hijos o con un solo hijo
         if (raiz->izq == NULL) {
             Persona* temp = raiz->der;
             delete raiz;
+            totalNodos--;
             return temp;
         } else if (raiz->der == NULL) {
             Persona* temp = raiz->izq;
             delete raiz;
+            totalNodos--;
             return temp;
         }
         
@@ -132,7 +338,25 @@ Persona* eliminar(Persona* raiz, int id) {
         raiz->id = temp->id;
         raiz->nombre = temp->nombre;
         raiz->fecha_nac = temp->fecha_nac;
-        raiz->der = eliminar(raiz->der, temp->id);
+        raiz->der = eliminarNodo(raiz->der, temp->id);
+    }
+    return raiz;
+}
+
+// =============================================================================
+// FUNCIN: eliminar
+// OBJETIVO: Elimina un nodo por su ID. Si el rbol queda por debajo de
+//           ALFA * maxNodos se reconstruye completo (costo amortizado O(1)
+//           por eliminacin, como en el rbol chivo expiatorio).
+// PARMETROS:
+//    - raiz: Puntero al nodo raz del rbol
+//    - id: Identificador del nodo a eliminar
+// RETORNO: Puntero a la nueva raz del rbol.
+// =============================================================================
+Persona* eliminar(Persona* raiz, int id) {
+    raiz = eliminarNodo(raiz, id);
+    if (totalNodos < ALFA * maxNodos) {
+        balancearArbol(raiz);
     }
     return raiz;
 }
@@ -180,90 +404,10 @@ void mostrarAncestros(Persona* persona, int nivel = 0) {
 
 // =============================================================================
 // CONSTANTE: MAX_NODOS
-// DESCRIPCIN: Tamao mximo para estructuras auxiliares (ej. listas/colas).
+// DESCRIPCIN: Tamao mximo de la cola del recorrido por niveles.
 // =============================================================================
 const int MAX_NODOS = 100;
 
-// =============================================================================
-// ESTRUCTURA: ListaPersonas
-// DESCRIPCIN: Almacena un arreglo de punteros a nodos Persona y su cantidad.
-// =============================================================================
-struct ListaPersonas {
-    Persona* elementos[MAX_NODOS];  // Arreglo de punteros a Persona
-    int cantidad;                   // Nmero actual de elementos
-};
-
-// =============================================================================
-// FUNCIN: inicializarLista
-// OBJETIVO: Inicializa una lista vaca.
-// PARMETROS:
-//    - lista: Referencia a la lista a inicializar
-// =============================================================================
-void inicializarLista(ListaPersonas &lista) {
-    lista.cantidad = 0;
-}
-
-// =============================================================================
-// FUNCIN: agregarALista
-// OBJETIVO: Aade un puntero a Persona a la lista si hay espacio.
-// PARMETROS:
-//    - lista: Referencia a la lista
-//    - p: Puntero al nodo Persona a agregar
-// =============================================================================
-void agregarALista(ListaPersonas &lista, Persona* p) {
-    if (lista.cantidad < MAX_NODOS) {
-        lista.elementos[lista.cantidad++] = p;
-    }
-}
-
-// =============================================================================
-// FUNCIN: almacenarNodos
-// OBJETIVO: Almacena todos los nodos del rbol en una lista (recorrido inorden).
-// PARMETROS:
-//    - raiz: Puntero al nodo raz del rbol
-//    - lista: Referencia a la lista donde se almacenarn los nodos
-// =============================================================================
-void almacenarNodos(Persona* raiz, ListaPersonas &lista) {
-    if (raiz == NULL) return;
-    almacenarNodos(raiz->izq, lista);
-    agregarALista(lista, raiz);
-    almacenarNodos(raiz->der, lista);
-}
-
-// =============================================================================
-// FUNCIN: construirArbolBalanceado
-// OBJETIVO: Construye un rbol balanceado a partir de una lista ordenada.
-// PARMETROS:
-//    - lista: Lista de nodos ordenados
-//    - inicio: ndice de inicio del subarreglo
-//    - fin: ndice de fin del subarreglo
-// RETORNO: Puntero a la raz del nuevo subrbol balanceado.
-// =============================================================================
-Persona* construirArbolBalanceado(ListaPersonas &lista, int inicio, int fin) {
-    if (inicio > fin) return NULL;
-    
-    int medio = (inicio + fin) / 2;
-    Persona* raiz = lista.elementos[medio];
-    
-    raiz->izq = construirArbolBalanceado(lista, inicio, medio - 1);
-    raiz->der = construirArbolBalanceado(lista, medio + 1, fin);
-    
-    return raiz;
-}
-
-// =============================================================================
-// FUNCIN: balancearArbol
-// OBJETIVO: Balancea el rbol para optimizar futuras operaciones.
-// PARMETROS:
-//    - raiz: Referencia al puntero raz del rbol
-// =============================================================================
-void balancearArbol(Persona* &raiz) {
-    ListaPersonas lista;
-    inicializarLista(lista);
-    almacenarNodos(raiz, lista);
-    raiz = construirArbolBalanceado(lista, 0, lista.cantidad - 1);
-}
-
 // =============================================================================
 // ESTRUCTURA: Cola
 // DESCRIPCIN: Implementa una cola FIFO para el recorrido por niveles (BFS).
@@ -395,7 +539,7 @@ void menu() {
         cout << "5. Mostrar por niveles" << endl;
         cout << "6. Mostrar ancestros" << endl;
         cout << "7. Mostrar descendientes" << endl;
-        cout << "8. Balancear arbol" << endl;
+        cout << "8. Estado del balance" << endl;
         cout << "9. Salir" << endl;
         cout << "Ingrese opcion: ";
         cin >> opcion;
@@ -457,8 +601,12 @@ void menu() {
             }
                 
             case 8: {
-                balancearArbol(arbol);
-                cout << "Arbol balanceado" << endl;
+                cout << "\nEstado del balance (automatico):" << endl;
+                cout << "Nodos: " << totalNodos << " (maximo " << maxNodos << ")" << endl;
+                cout << "Altura: " << alturaArbol(arbol)
+                     << " (limite " << profundidadPermitida(totalNodos) + 1 << ")" << endl;
+                cout << "Reconstrucciones: " << reconstrucciones
+                     << " (" << nodosReconstruidos << " nodos movidos)" << endl;
                 break;
             }
                 
@@ -2,47 +2,493 @@
 #include <string>
 #include <iomanip>
 #include <sstream>
+#include <cmath>
+#include <new>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 using namespace std;
 
+// =============================================================================
+// ESTRUCTURA: Fecha
+// Fecha empaquetada en 32 bits: anio << 9 | mes << 5 | dia. Comparar dos
+// fechas es comparar dos enteros y el orden coincide con el cronolgico.
+// El valor 0 representa una fecha desconocida.
+// =============================================================================
+struct Fecha {
+    unsigned int valor;
+};
+
+const Fecha FECHA_DESCONOCIDA = {0};
+
+Fecha empaquetarFecha(int dia, int mes, int anio) {
+    Fecha f;
+    f.valor = ((unsigned int)anio << 9) | ((unsigned int)mes << 5) | (unsigned int)dia;
+    return f;
+}
+
+int diaDe(Fecha f)  { return f.valor & 31; }
+int mesDe(Fecha f)  { return (f.valor >> 5) & 15; }
+int anioDe(Fecha f) { return f.valor >> 9; }
+
+bool operator<(Fecha a, Fecha b)  { return a.valor < b.valor; }
+bool operator==(Fecha a, Fecha b) { return a.valor == b.valor; }
+
+bool esBisiesto(int anio) {
+    return (anio % 4 == 0 && anio % 100 != 0) || anio % 400 == 0;
+}
+
+int diasDelMes(int mes, int anio) {
+    static const int dias[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (mes == 2 && esBisiesto(anio)) return 29;
+    return dias[mes - 1];
+}
+
+// Lee "dd/mm/aaaa" sin crear cadenas temporales.
+// RETORNO: false si el formato o el da del calendario no son vlidos.
+bool parsearFecha(const char* texto, Fecha &resultado) {
+    for (int i = 0; i < 10; i++) {
+        char c = texto[i];
+        if (i == 2 || i == 5) {
+            if (c != '/') return false;
+        } else if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    if (texto[10] != '\0') return false;
+
+    int dia = (texto[0] - '0') * 10 + (texto[1] - '0');
+    int mes = (texto[3] - '0') * 10 + (texto[4] - '0');
+    int anio = (texto[6] - '0') * 1000 + (texto[7] - '0') * 100 + (texto[8] - '0') * 10 + (texto[9] - '0');
+
+    if (mes < 1 || mes > 12) return false;
+    if (dia < 1 || dia > diasDelMes(mes, anio)) return false;
+
+    resultado = empaquetarFecha(dia, mes, anio);
+    return true;
+}
+
+// Escribe "dd/mm/aaaa" en destino (al menos 11 bytes).
+void formatearFecha(Fecha f, char* destino) {
+    if (f.valor == 0) {
+        const char* desconocida = "--/--/----";
+        for (int i = 0; i <= 10; i++) destino[i] = desconocida[i];
+        return;
+    }
+    int dia = diaDe(f), mes = mesDe(f), anio = anioDe(f);
+    destino[0] = '0' + dia / 10;
+    destino[1] = '0' + dia % 10;
+    destino[2] = '/';
+    destino[3] = '0' + mes / 10;
+    destino[4] = '0' + mes % 10;
+    destino[5] = '/';
+    destino[6] = '0' + (anio / 1000) % 10;
+    destino[7] = '0' + (anio / 100) % 10;
+    destino[8] = '0' + (anio / 10) % 10;
+    destino[9] = '0' + anio % 10;
+    destino[10] = '\0';
+}
+
+ostream& operator<<(ostream &os, Fecha f) {
+    char texto[11];
+    formatearFecha(f, texto);
+    return os << texto;
+}
+
+// Das transcurridos desde el 01/01/1970 (calendario gregoriano prolptico).
+long diasDesdeEpoca(Fecha f) {
+    long anio = anioDe(f);
+    long mes = mesDe(f);
+    long dia = diaDe(f);
+    anio -= (mes <= 2);
+    long era = (anio >= 0 ? anio : anio - 399) / 400;
+    long anioEra = anio - era * 400;
+    long diaAnio = (153 * (mes + (mes > 2 ? -3 : 9)) + 2) / 5 + dia - 1;
+    long diaEra = anioEra * 365 + anioEra / 4 - anioEra / 100 + diaAnio;
+    return era * 146097 + diaEra - 719468;
+}
+
+long diasEntre(Fecha desde, Fecha hasta) {
+    return diasDesdeEpoca(hasta) - diasDesdeEpoca(desde);
+}
+
+// Aos cumplidos en la fecha dada. Los bits bajos (mes, da) se comparan
+// como un solo entero.
+int edadEn(Fecha nacimiento, Fecha hoy) {
+    int edad = anioDe(hoy) - anioDe(nacimiento);
+    if ((hoy.valor & 0x1FF) < (nacimiento.valor & 0x1FF)) edad--;
+    return edad;
+}
+
+Fecha fechaActual() {
+    time_t ahora = time(NULL);
+    tm* local = localtime(&ahora);
+    return empaquetarFecha(local->tm_mday, local->tm_mon + 1, local->tm_year + 1900);
+}
+
+// =============================================================================
+// ESTRUCTURA: Cadena
+// Texto inmutable que no es dueo de su memoria: apunta al montculo de
+// cadenas o directamente a una instantnea mapeada en memoria, as cargar
+// una instantnea no reserva memoria por persona.
+// =============================================================================
+struct Cadena {
+    const char* datos;
+    int largo;
+};
+
+ostream& operator<<(ostream &os, const Cadena &c) {
+    streamsize relleno = os.width() > c.largo ? os.width() - c.largo : 0;
+    bool izquierda = (os.flags() & ios::adjustfield) == ios::left;
+    os.width(0);
+    if (!izquierda) for (streamsize i = 0; i < relleno; i++) os.put(os.fill());
+    os.write(c.datos, c.largo);
+    if (izquierda) for (streamsize i = 0; i < relleno; i++) os.put(os.fill());
+    return os;
+}
+
+// Montculo de cadenas: bloques de 64 KB que nunca se mueven, por eso las
+// Cadena que apuntan a ellos siguen vlidas. Se libera entero con la base;
+// el texto de las personas eliminadas no se recupera antes.
+const int TAM_BLOQUE_CADENAS = 1 << 16;
+
+struct BloqueCadenas {
+    char* datos;
+    int usados;
+    int capacidad;
+    BloqueCadenas* siguiente;
+};
+
+struct MonticuloCadenas {
+    BloqueCadenas* bloques;     // El primero es el bloque en uso
+    long bytes;
+};
+
+MonticuloCadenas monticuloCadenas = {NULL, 0};
+
+Cadena guardarCadena(const char* texto, int largo) {
+    BloqueCadenas* b = monticuloCadenas.bloques;
+    if (b == NULL || b->usados + largo > b->capacidad) {
+        b = new BloqueCadenas;
+        b->capacidad = (largo > TAM_BLOQUE_CADENAS) ? largo : TAM_BLOQUE_CADENAS;
+        b->datos = new char[b->capacidad];
+        b->usados = 0;
+        b->siguiente = monticuloCadenas.bloques;
+        monticuloCadenas.bloques = b;
+        monticuloCadenas.bytes += b->capacidad;
+    }
+    Cadena c;
+    c.datos = b->datos + b->usados;
+    c.largo = largo;
+    memcpy(b->datos + b->usados, texto, largo);
+    b->usados += largo;
+    return c;
+}
+
+Cadena guardarCadena(const string &texto) {
+    return guardarCadena(texto.data(), (int)texto.size());
+}
+
+void liberarMonticulo() {
+    BloqueCadenas* b = monticuloCadenas.bloques;
+    while (b != NULL) {
+        BloqueCadenas* sig = b->siguiente;
+        delete[] b->datos;
+        delete b;
+        b = sig;
+    }
+    monticuloCadenas.bloques = NULL;
+    monticuloCadenas.bytes = 0;
+}
+
 // =============================================================================
 // ESTRUCTURA: Persona
 // =============================================================================
 struct Persona {
     int id;
-    string nombre;
-    string fecha_nac;
+    Cadena nombre;
+    Fecha fecha_nac;
     Persona* padre;
     Persona* madre;
     Persona* izq;
     Persona* der;
+    int altura;         // Altura del subrbol (ndice AVL)
+    int generacion;     // Camino ms largo hasta un fundador (ver GENERACIONES)
+    int profundidad;    // Camino ms largo hasta un descendiente
+    int celda;          // Posicin densa en la arena (ver limiteCeldas)
 };
 
 
 // =============================================================================
 // VALIDACIN DE FECHA
 // =============================================================================
-bool esValida(string fecha) {
-    if (fecha.length() != 10 || fecha[2] != '/' || fecha[5] != '/') {
+bool esValida(const string &texto, Fecha &fecha) {
+    if (texto.length() != 10 || !parsearFecha(texto.c_str(), fecha)) {
         return false;
     }
+    if (anioDe(fecha) < 1900 || anioDe(fecha) > 2025) return false;
     
-    for (int i = 0; i < 10; i++) {
-        if (i != 2 && i != 5 && !isdigit(fecha[i])) {
-            return false;
+    return true;
+}
+
+// =============================================================================
+// RECORRIDOS ITERATIVOS
+// Recorren el rbol con una pila explcita en el heap en lugar de la pila de
+// llamadas, as ningn tamao de rbol puede desbordarla. Cada recorrido
+// llama a visitar(nodo) en el orden correspondiente y se detiene en cuanto
+// visitar devuelve false (por ejemplo, cuando la pgina ya est completa).
+// =============================================================================
+typedef bool (*VisitaPersona)(Persona*);
+
+struct Pila {
+    Persona** elementos;
+    int capacidad;
+    int cantidad;
+};
+
+void inicializarPila(Pila &p) {
+    p.capacidad = 64;
+    p.elementos = new Persona*[p.capacidad];
+    p.cantidad = 0;
+}
+
+void liberarPila(Pila &p) {
+    delete[] p.elementos;
+    p.elementos = NULL;
+    p.capacidad = 0;
+    p.cantidad = 0;
+}
+
+void apilar(Pila &p, Persona* nodo) {
+    if (p.cantidad == p.capacidad) {
+        Persona** nuevos = new Persona*[p.capacidad * 2];
+        for (int i = 0; i < p.cantidad; i++) {
+            nuevos[i] = p.elementos[i];
         }
+        delete[] p.elementos;
+        p.elementos = nuevos;
+        p.capacidad *= 2;
     }
-    
-    int dia = stoi(fecha.substr(0, 2));
-    int mes = stoi(fecha.substr(3, 2));
-    int anio = stoi(fecha.substr(6, 4));
-    
-    if (mes < 1 || mes > 12) return false;
-    if (dia < 1 || dia > 31) return false;
-    if (mes == 2 && dia > 29) return false;
-    if ((mes == 4 || mes == 6 || mes == 9 || mes == 11) && dia > 30) return false;
-    if (anio < 1900 || anio > 2025) return false;
-    
+    p.elementos[p.cantidad++] = nodo;
+}
+
+Persona* desapilar(Pila &p) {
+    return p.elementos[--p.cantidad];
+}
+
+Persona* cima(Pila &p) {
+    return p.elementos[p.cantidad - 1];
+}
+
+bool pilaVacia(Pila &p) {
+    return p.cantidad == 0;
+}
+
+void recorrerPreorden(Persona* raiz, VisitaPersona visitar) {
+    if (raiz == NULL) return;
+    Pila p;
+    inicializarPila(p);
+    apilar(p, raiz);
+    while (!pilaVacia(p)) {
+        Persona* actual = desapilar(p);
+        if (!visitar(actual)) break;
+        if (actual->der != NULL) apilar(p, actual->der);
+        if (actual->izq != NULL) apilar(p, actual->izq);
+    }
+    liberarPila(p);
+}
+
+void recorrerInorden(Persona* raiz, VisitaPersona visitar) {
+    Pila p;
+    inicializarPila(p);
+    Persona* actual = raiz;
+    while (actual != NULL || !pilaVacia(p)) {
+        while (actual != NULL) {
+            apilar(p, actual);
+            actual = actual->izq;
+        }
+        actual = desapilar(p);
+        if (!visitar(actual)) break;
+        actual = actual->der;
+    }
+    liberarPila(p);
+}
+
+void recorrerPostorden(Persona* raiz, VisitaPersona visitar) {
+    Pila p;
+    inicializarPila(p);
+    Persona* actual = raiz;
+    Persona* ultimo = NULL;
+    while (actual != NULL || !pilaVacia(p)) {
+        if (actual != NULL) {
+            apilar(p, actual);
+            actual = actual->izq;
+        } else {
+            Persona* tope = cima(p);
+            if (tope->der != NULL && tope->der != ultimo) {
+                actual = tope->der;
+            } else {
+                if (!visitar(tope)) break;
+                ultimo = desapilar(p);
+            }
+        }
+    }
+    liberarPila(p);
+}
+
+// Quita los hilos de Morris que siguen puestos al detenerse en 'ultimo':
+// son los de los ancestros de 'ultimo' en cuyo subrbol izquierdo est.
+// Se baja desde la raz por ID, as que cuesta O(altura).
+void deshacerHilosMorris(Persona* raiz, Persona* ultimo) {
+    Persona* n = raiz;
+    while (n != NULL && n != ultimo) {
+        if (ultimo->id < n->id) {
+            Persona* pred = n->izq;
+            while (pred->der != NULL && pred->der != n) pred = pred->der;
+            if (pred->der == n) pred->der = NULL;
+            n = n->izq;
+        } else {
+            n = n->der;
+        }
+    }
+}
+
+// Inorden de Morris: enhebra temporalmente cada predecesor hacia su sucesor
+// y deshace el hilo al volver. Memoria extra O(1); el rbol queda intacto al
+// terminar (tambin si visitar lo detiene), pero visitar no debe modificarlo.
+void recorrerInordenMorris(Persona* raiz, VisitaPersona visitar) {
+    Persona* actual = raiz;
+    while (actual != NULL) {
+        if (actual->izq == NULL) {
+            if (!visitar(actual)) {
+                deshacerHilosMorris(raiz, actual);
+                return;
+            }
+            actual = actual->der;
+            continue;
+        }
+        Persona* pred = actual->izq;
+        while (pred->der != NULL && pred->der != actual) {
+            pred = pred->der;
+        }
+        if (pred->der == NULL) {
+            pred->der = actual;
+            actual = actual->izq;
+        } else {
+            pred->der = NULL;
+            if (!visitar(actual)) {
+                deshacerHilosMorris(raiz, actual);
+                return;
+            }
+            actual = actual->der;
+        }
+    }
+}
+
+// =============================================================================
+// LISTA DE ENTEROS Y MARCAS DE VISITA
+// Utilidades para las consultas sobre la red familiar (padre/madre/hijos).
+// Las marcas usan una poca: empezar una visita nueva no borra el arreglo,
+// solo incrementa el nmero de poca.
+// =============================================================================
+struct ListaEnteros {
+    int* datos;
+    int cantidad;
+    int capacidad;
+};
+
+void inicializarEnteros(ListaEnteros &l) {
+    l.datos = NULL;
+    l.cantidad = 0;
+    l.capacidad = 0;
+}
+
+void liberarEnteros(ListaEnteros &l) {
+    delete[] l.datos;
+    inicializarEnteros(l);
+}
+
+void agregarEntero(ListaEnteros &l, int valor) {
+    if (l.cantidad == l.capacidad) {
+        int nuevaCap = (l.capacidad == 0) ? 16 : l.capacidad * 2;
+        int* nuevos = new int[nuevaCap];
+        for (int i = 0; i < l.cantidad; i++) {
+            nuevos[i] = l.datos[i];
+        }
+        delete[] l.datos;
+        l.datos = nuevos;
+        l.capacidad = nuevaCap;
+    }
+    l.datos[l.cantidad++] = valor;
+}
+
+struct MarcasVisita {
+    unsigned int* marcas;   // marcas[celda] == epoca  <=>  celda visitada
+    int capacidad;
+    unsigned int epoca;
+};
+
+void inicializarMarcas(MarcasVisita &m) {
+    m.marcas = NULL;
+    m.capacidad = 0;
+    m.epoca = 0;
+}
+
+void liberarMarcas(MarcasVisita &m) {
+    delete[] m.marcas;
+    inicializarMarcas(m);
+}
+
+// Empieza una visita nueva vlida para posiciones menores que limite
+// (celdas de la arena, o ndices de registro en las vistas).
+void nuevaVisita(MarcasVisita &m, int limite) {
+    if (limite > m.capacidad) {
+        int nuevaCap = (m.capacidad == 0) ? 1024 : m.capacidad;
+        while (nuevaCap < limite) nuevaCap *= 2;
+        unsigned int* nuevas = new unsigned int[nuevaCap];
+        for (int i = 0; i < nuevaCap; i++) {
+            nuevas[i] = (i < m.capacidad) ? m.marcas[i] : 0;
+        }
+        delete[] m.marcas;
+        m.marcas = nuevas;
+        m.capacidad = nuevaCap;
+    }
+    if (++m.epoca == 0) {
+        for (int i = 0; i < m.capacidad; i++) m.marcas[i] = 0;
+        m.epoca = 1;
+    }
+}
+
+bool visitado(MarcasVisita &m, int pos) {
+    return m.marcas[pos] == m.epoca;
+}
+
+// RETORNO: true si la posicin no estaba marcada en esta visita.
+bool marcarVisitado(MarcasVisita &m, int pos) {
+    if (m.marcas[pos] == m.epoca) return false;
+    m.marcas[pos] = m.epoca;
     return true;
 }
 
@@ -51,20 +497,126 @@ bool esValida(string fecha) {
 // =============================================================================
 int proximoID = 1;
 
+bool considerarID(Persona* p) {
+    if (p->id >= proximoID) {
+        proximoID = p->id + 1;
+    }
+    return true;
+}
+
 void actualizarProximoID(Persona* raiz) {
-    if (raiz == NULL) return;
-    if (raiz->id >= proximoID) {
-        proximoID = raiz->id + 1;
+    recorrerPreorden(raiz, considerarID);
+}
+
+// =============================================================================
+// ARENA DE NODOS Persona
+// Los nodos se reparten de bloques grandes y contiguos en lugar de un
+// new/delete por persona: las inserciones consecutivas quedan juntas en
+// memoria y los huecos de las eliminadas se reciclan con una lista libre.
+// Cada celda tiene un nmero fijo (bloque * PERSONAS_POR_BLOQUE + posicin)
+// que no pasa de la cantidad mxima de personas vivas a la vez: los
+// arreglos auxiliares por persona (marcas de visita, distancias, F...) se
+// indexan por celda y no por ID, as un ID enorme no agranda nada.
+// =============================================================================
+const int PERSONAS_POR_BLOQUE = 1024;
+
+struct CeldaLibre {
+    CeldaLibre* siguiente;
+    int celda;
+};
+
+struct BloqueArena {
+    char* memoria;              // PERSONAS_POR_BLOQUE celdas de sizeof(Persona)
+    BloqueArena* siguiente;
+};
+
+struct ArenaPersonas {
+    BloqueArena* bloques;       // El primero es el bloque en uso
+    int usadasBloque;           // Celdas ya entregadas del bloque en uso
+    CeldaLibre* libres;         // Celdas devueltas, listas para reutilizar
+    long numBloques;
+    long vivos;
+    long enListaLibre;
+};
+
+ArenaPersonas arenaPersonas = {NULL, PERSONAS_POR_BLOQUE, NULL, 0, 0, 0};
+
+void* reservarCelda(int &numero) {
+    ArenaPersonas &a = arenaPersonas;
+    a.vivos++;
+
+    if (a.libres != NULL) {
+        CeldaLibre* celda = a.libres;
+        a.libres = celda->siguiente;
+        a.enListaLibre--;
+        numero = celda->celda;
+        return celda;
+    }
+
+    if (a.usadasBloque == PERSONAS_POR_BLOQUE) {
+        BloqueArena* bloque = new BloqueArena;
+        bloque->memoria = static_cast<char*>(::operator new(sizeof(Persona) * PERSONAS_POR_BLOQUE));
+        bloque->siguiente = a.bloques;
+        a.bloques = bloque;
+        a.usadasBloque = 0;
+        a.numBloques++;
+    }
+    numero = (int)(a.numBloques - 1) * PERSONAS_POR_BLOQUE + a.usadasBloque;
+    return a.bloques->memoria + sizeof(Persona) * a.usadasBloque++;
+}
+
+// Cota superior (exclusiva) de los nmeros de celda entregados.
+int limiteCeldas() {
+    return (int)arenaPersonas.numBloques * PERSONAS_POR_BLOQUE;
+}
+
+void liberarCelda(Persona* p) {
+    int numero = p->celda;
+    p->~Persona();
+    CeldaLibre* celda = reinterpret_cast<CeldaLibre*>(p);
+    celda->celda = numero;
+    celda->siguiente = arenaPersonas.libres;
+    arenaPersonas.libres = celda;
+    arenaPersonas.enListaLibre++;
+    arenaPersonas.vivos--;
+}
+
+// Devuelve de golpe todos los bloques. Los nodos vivos ya deben estar
+// destruidos (ver liberarArbol).
+void liberarArena() {
+    BloqueArena* b = arenaPersonas.bloques;
+    while (b != NULL) {
+        BloqueArena* sig = b->siguiente;
+        ::operator delete(b->memoria);
+        delete b;
+        b = sig;
     }
-    actualizarProximoID(raiz->izq);
-    actualizarProximoID(raiz->der);
+    arenaPersonas.bloques = NULL;
+    arenaPersonas.usadasBloque = PERSONAS_POR_BLOQUE;
+    arenaPersonas.libres = NULL;
+    arenaPersonas.numBloques = 0;
+    arenaPersonas.vivos = 0;
+    arenaPersonas.enListaLibre = 0;
+}
+
+long bytesReservadosArena() {
+    return arenaPersonas.numBloques * (long)(sizeof(Persona) * PERSONAS_POR_BLOQUE + sizeof(BloqueArena));
+}
+
+// Porcentaje de celdas entregadas alguna vez que hoy estn libres.
+double fragmentacionArena() {
+    long entregadas = arenaPersonas.vivos + arenaPersonas.enListaLibre;
+    if (entregadas == 0) return 0.0;
+    return 100.0 * arenaPersonas.enListaLibre / entregadas;
 }
 
 // =============================================================================
 // FUNCIN: crearPersona
 // =============================================================================
-Persona* crearPersona(int id, string nombre, string fecha) {
-    Persona* nueva = new Persona;
+Persona* crearPersona(int id, Cadena nombre, Fecha fecha) {
+    int celda;
+    Persona* nueva = new (reservarCelda(celda)) Persona;
+    nueva->celda = celda;
     nueva->id = id;
     nueva->nombre = nombre;
     nueva->fecha_nac = fecha;
@@ -72,40 +624,130 @@ Persona* crearPersona(int id, string nombre, string fecha) {
     nueva->madre = NULL;
     nueva->izq = NULL;
     nueva->der = NULL;
+    nueva->altura = 1;
+    nueva->generacion = 0;
+    nueva->profundidad = 0;
     return nueva;
 }
 
 // =============================================================================
-// FUNCIN: insertar
+// NDICE AVL
+// Los IDs llegan siempre en orden creciente (proximoID++), as que sin
+// balanceo el rbol degenera en una lista. Cada insercin y eliminacin
+// reequilibra el camino recorrido con rotaciones AVL: altura <= 1.44*log2(n).
 // =============================================================================
-void insertar(Persona* &raiz, int id, string nombre, string fecha, Persona* padre, Persona* madre) {
-    if (raiz == NULL) {
-        raiz = crearPersona(id, nombre, fecha);
-        raiz->padre = padre;
-        raiz->madre = madre;
-        return;
+const int MAX_ALTURA_AVL = 64;   // Cota holgada: un AVL de altura 64 no cabe en memoria
+
+struct EstadisticasAVL {
+    long nodos;
+    long rotacionesSimples;
+    long rotacionesDobles;
+};
+
+EstadisticasAVL estadisticasAVL = {0, 0, 0};
+
+int altura(Persona* nodo) {
+    return (nodo == NULL) ? 0 : nodo->altura;
+}
+
+void actualizarAltura(Persona* nodo) {
+    int hi = altura(nodo->izq);
+    int hd = altura(nodo->der);
+    nodo->altura = (hi > hd ? hi : hd) + 1;
+}
+
+int factorBalance(Persona* nodo) {
+    return altura(nodo->izq) - altura(nodo->der);
+}
+
+Persona* rotarDerecha(Persona* y) {
+    Persona* x = y->izq;
+    y->izq = x->der;
+    x->der = y;
+    actualizarAltura(y);
+    actualizarAltura(x);
+    return x;
+}
+
+Persona* rotarIzquierda(Persona* x) {
+    Persona* y = x->der;
+    x->der = y->izq;
+    y->izq = x;
+    actualizarAltura(x);
+    actualizarAltura(y);
+    return y;
+}
+
+// Recalcula la altura del nodo y aplica la rotacin necesaria.
+// RETORNO: nueva raz del subrbol.
+Persona* balancear(Persona* nodo) {
+    actualizarAltura(nodo);
+    int factor = factorBalance(nodo);
+
+    if (factor > 1) {
+        if (factorBalance(nodo->izq) < 0) {
+            nodo->izq = rotarIzquierda(nodo->izq);
+            estadisticasAVL.rotacionesDobles++;
+        } else {
+            estadisticasAVL.rotacionesSimples++;
+        }
+        return rotarDerecha(nodo);
     }
-    
-    if (id < raiz->id) {
-        insertar(raiz->izq, id, nombre, fecha, padre, madre);
-    } else if (id > raiz->id) {
-        insertar(raiz->der, id, nombre, fecha, padre, madre);
+    if (factor < -1) {
+        if (factorBalance(nodo->der) > 0) {
+            nodo->der = rotarDerecha(nodo->der);
+            estadisticasAVL.rotacionesDobles++;
+        } else {
+            estadisticasAVL.rotacionesSimples++;
+        }
+        return rotarIzquierda(nodo);
+    }
+    return nodo;
+}
+
+// Reequilibra de abajo hacia arriba los enlaces guardados en el camino.
+// Si un subrbol conserva su altura, sus ancestros no cambian y se corta.
+void rebalancearCamino(Persona** camino[], int largo) {
+    while (largo > 0) {
+        Persona** enlace = camino[--largo];
+        int alturaAntes = (*enlace)->altura;
+        *enlace = balancear(*enlace);
+        if ((*enlace)->altura == alturaAntes) break;
+    }
+}
+
+// =============================================================================
+// FUNCIN: insertar
+// RETORNO: el nodo creado, o NULL si el ID ya exista.
+Persona* insertar(Persona* &raiz, int id, Cadena nombre, Fecha fecha, Persona* padre, Persona* madre) {
+    Persona** camino[MAX_ALTURA_AVL];
+    int largo = 0;
+    Persona** enlace = &raiz;
+
+    while (*enlace != NULL) {
+        if (id == (*enlace)->id) return NULL;
+        camino[largo++] = enlace;
+        enlace = (id < (*enlace)->id) ? &(*enlace)->izq : &(*enlace)->der;
     }
+
+    Persona* nueva = crearPersona(id, nombre, fecha);
+    nueva->padre = padre;
+    nueva->madre = madre;
+    *enlace = nueva;
+    estadisticasAVL.nodos++;
+
+    rebalancearCamino(camino, largo);
+    return nueva;
 }
 
 // =============================================================================
 // FUNCIN: buscar
 // =============================================================================
 Persona* buscar(Persona* raiz, int id) {
-    if (raiz == NULL || raiz->id == id) {
-        return raiz;
-    }
-    
-    if (id < raiz->id) {
-        return buscar(raiz->izq, id);
-    } else {
-        return buscar(raiz->der, id);
+    while (raiz != NULL && raiz->id != id) {
+        raiz = (id < raiz->id) ? raiz->izq : raiz->der;
     }
+    return raiz;
 }
 
 // =============================================================================
@@ -122,224 +764,5749 @@ Persona* encontrarMinimo(Persona* raiz) {
 // FUNCIN: eliminar
 // =============================================================================
 Persona* eliminar(Persona* raiz, int id) {
-    if (raiz == NULL) return raiz;
+    Persona** camino[MAX_ALTURA_AVL];
+    int largo = 0;
+    Persona** enlace = &raiz;
+
+    while (*enlace != NULL && (*enlace)->id != id) {
+        camino[largo++] = enlace;
+        enlace = (id < (*enlace)->id) ? &(*enlace)->izq : &(*enlace)->der;
+    }
+    if (*enlace == NULL) return raiz;
 
-    if (id < raiz->id) {
-        raiz->izq = eliminar(raiz->izq, id);
-    } else if (id > raiz->id) {
-        raiz->der = eliminar(raiz->der, id);
+    Persona* objetivo = *enlace;
+    if (objetivo->izq == NULL) {
+        *enlace = objetivo->der;
+    } else if (objetivo->der == NULL) {
+        *enlace = objetivo->izq;
     } else {
-        if (raiz->izq == NULL) {
-            Persona* temp = raiz->der;
-            delete raiz;
-            return temp;
-        } else if (raiz->der == NULL) {
-            Persona* temp = raiz->izq;
-            delete raiz;
-            return temp;
+        // Dos hijos: el sucesor se reenlaza en el lugar del nodo en vez de
+        // copiar sus datos, as los punteros padre/madre hacia l siguen vlidos.
+        int posObjetivo = largo;
+        camino[largo++] = enlace;
+
+        Persona** e = &objetivo->der;
+        while ((*e)->izq != NULL) {
+            camino[largo++] = e;
+            e = &(*e)->izq;
+        }
+        Persona* sucesor = *e;
+        *e = sucesor->der;
+        sucesor->izq = objetivo->izq;
+        sucesor->der = objetivo->der;
+        sucesor->altura = objetivo->altura;
+        *enlace = sucesor;
+
+        if (largo > posObjetivo + 1) {
+            camino[posObjetivo + 1] = &sucesor->der;
         }
-        
-        Persona* temp = encontrarMinimo(raiz->der);
-        raiz->id = temp->id;
-        raiz->nombre = temp->nombre;
-        raiz->fecha_nac = temp->fecha_nac;
-        raiz->der = eliminar(raiz->der, temp->id);
     }
+
+    liberarCelda(objetivo);
+    estadisticasAVL.nodos--;
+
+    rebalancearCamino(camino, largo);
     return raiz;
 }
 
 // =============================================================================
-// TABLA DE DATOS
+// FUNCIN: liberarArbol
+// Destruye todos los nodos y devuelve la memoria de la arena en bloque.
 // =============================================================================
-struct TablaPersonas {
-    Persona* personas[100];
-    int cantidad;
+void destruirNodos(Persona* raiz) {
+    if (raiz == NULL) return;
+    destruirNodos(raiz->izq);
+    destruirNodos(raiz->der);
+    raiz->~Persona();
+}
+
+void liberarArbol(Persona* &raiz) {
+    destruirNodos(raiz);
+    raiz = NULL;
+    liberarArena();
+    estadisticasAVL.nodos = 0;
+}
+
+// =============================================================================
+// ALMACN DIRECTO POR ID
+// Los IDs de proximoID son densos y crecientes, as que el propio ID es el
+// ndice de su casilla: buscarPorID es un solo acceso a arreglo. Las casillas
+// viven en bloques fijos que nunca se mueven; solo el directorio de bloques
+// se duplica al crecer. Las personas eliminadas dejan una lpida. Un ID
+// suelto muy alto cuesta un bloque y un directorio ms largo; los IDs van
+// de 0 a ID_MAXIMO.
+// Cada registro en una casilla recibe una versin nueva (un contador global
+// que no se reinicia ni al vaciar la base), as una referencia guardada
+// (RefPersona: ID + versin) detecta en O(1) que su persona ya no existe
+// aunque el ID se haya vuelto a usar.
+// =============================================================================
+const int ID_MAXIMO = 999999999;
+const int BITS_BLOQUE_ID = 12;
+const int TAM_BLOQUE_ID = 1 << BITS_BLOQUE_ID;    // 4096 casillas por bloque
+
+enum EstadoCasilla {
+    CASILLA_VACIA = 0,      // El ID nunca se us
+    CASILLA_OCUPADA,
+    CASILLA_BORRADA         // Lpida: el ID existi y fue eliminado
 };
 
-TablaPersonas tablaGlobal;
+struct CasillaID {
+    Persona* persona;       // NULL salvo en casillas ocupadas
+    unsigned int version;   // Versin del ltimo registro en la casilla
+    unsigned char estado;
+};
 
-void inicializarTabla() {
-    tablaGlobal.cantidad = 0;
+struct AlmacenIDs {
+    CasillaID** bloques;    // Directorio: bloques[id >> BITS_BLOQUE_ID]
+    int numBloques;
+    int vivos;
+    int lapidas;
+    unsigned int ultimaVersion;
+};
+
+AlmacenIDs almacenGlobal = {NULL, 0, 0, 0, 0};
+
+struct RefPersona {
+    int id;
+    unsigned int version;   // 0 = referencia nula
+};
+
+Persona* buscarPorID(int id) {
+    if (id < 0) return NULL;
+    int b = id >> BITS_BLOQUE_ID;
+    if (b >= almacenGlobal.numBloques || almacenGlobal.bloques[b] == NULL) return NULL;
+    return almacenGlobal.bloques[b][id & (TAM_BLOQUE_ID - 1)].persona;
 }
 
-void agregarATabla(Persona* p) {
-    if (tablaGlobal.cantidad < 100) {
-        tablaGlobal.personas[tablaGlobal.cantidad++] = p;
+// true si p sigue registrado. Sirve para no seguir un padre/madre que
+// apunta a una persona ya eliminada.
+bool estaViva(Persona* p) {
+    return p != NULL && buscarPorID(p->id) == p;
+}
+
+// Cota superior (exclusiva) de los IDs que caben en el directorio.
+long limiteIDs() {
+    return (long)almacenGlobal.numBloques * TAM_BLOQUE_ID;
+}
+
+CasillaID* casillaPara(int id) {
+    int b = id >> BITS_BLOQUE_ID;
+
+    if (b >= almacenGlobal.numBloques) {
+        int nuevoTam = (almacenGlobal.numBloques == 0) ? 4 : almacenGlobal.numBloques;
+        while (nuevoTam <= b) nuevoTam *= 2;
+
+        CasillaID** nuevos = new CasillaID*[nuevoTam];
+        for (int i = 0; i < nuevoTam; i++) {
+            nuevos[i] = (i < almacenGlobal.numBloques) ? almacenGlobal.bloques[i] : NULL;
+        }
+        delete[] almacenGlobal.bloques;
+        almacenGlobal.bloques = nuevos;
+        almacenGlobal.numBloques = nuevoTam;
+    }
+
+    if (almacenGlobal.bloques[b] == NULL) {
+        CasillaID* bloque = new CasillaID[TAM_BLOQUE_ID];
+        for (int i = 0; i < TAM_BLOQUE_ID; i++) {
+            bloque[i].persona = NULL;
+            bloque[i].version = 0;
+            bloque[i].estado = CASILLA_VACIA;
+        }
+        almacenGlobal.bloques[b] = bloque;
     }
+    return &almacenGlobal.bloques[b][id & (TAM_BLOQUE_ID - 1)];
 }
 
-void llenarTabla(Persona* raiz) {
-    if (raiz == NULL) return;
-    llenarTabla(raiz->izq);
-    agregarATabla(raiz);
-    llenarTabla(raiz->der);
+void registrarEnAlmacen(Persona* p) {
+    CasillaID* c = casillaPara(p->id);
+    if (c->estado == CASILLA_BORRADA) almacenGlobal.lapidas--;
+    c->persona = p;
+    c->version = ++almacenGlobal.ultimaVersion;
+    if (c->version == 0) c->version = ++almacenGlobal.ultimaVersion;
+    c->estado = CASILLA_OCUPADA;
+    almacenGlobal.vivos++;
 }
 
-void mostrarTabla() {
-    cout << "\n+----------------------------------------------------------------------------+\n";
-    cout << "                          TABLA DE PERSONAS                                  \n";
-    cout << "----------------------------------------------------------------------------\n";
-    cout << " ID   NOMBRE                FECHA NACIMIENTO  PADRE  MADRE             \n";
-    cout << "----------------------------------------------------------------------------\n";
-    
-    inicializarTabla();
-    llenarTabla(tablaGlobal.personas[0] != NULL ? tablaGlobal.personas[0] : NULL);
-    
-    for (int i = 0; i < tablaGlobal.cantidad; i++) {
-        Persona* p = tablaGlobal.personas[i];
-        string padre = (p->padre != NULL) ? p->padre->nombre : "N/A";
-        string madre = (p->madre != NULL) ? p->madre->nombre : "N/A";
-        
-        cout << " " << setw(3) << p->id << "  " << setw(20) << left << p->nombre 
-             << " " << setw(16) << p->fecha_nac << " " << setw(5) << (p->padre != NULL ? to_string(p->padre->id) : "N/A")
-             << " " << setw(5) << (p->madre != NULL ? to_string(p->madre->id) : "N/A") << "\n";
+void borrarDeAlmacen(int id) {
+    if (buscarPorID(id) == NULL) return;
+    CasillaID* c = casillaPara(id);
+    c->persona = NULL;
+    c->estado = CASILLA_BORRADA;
+    almacenGlobal.vivos--;
+    almacenGlobal.lapidas++;
+}
+
+void vaciarAlmacen() {
+    for (int b = 0; b < almacenGlobal.numBloques; b++) {
+        delete[] almacenGlobal.bloques[b];
     }
-    
-    cout << "+----------------------------------------------------------------------------+\n";
+    delete[] almacenGlobal.bloques;
+    almacenGlobal.bloques = NULL;
+    almacenGlobal.numBloques = 0;
+    almacenGlobal.vivos = 0;
+    almacenGlobal.lapidas = 0;
 }
 
-// =============================================================================
-// FUNCIN: mostrarAncestros
-// =============================================================================
-void mostrarAncestros(Persona* persona, int nivel = 0) {
+RefPersona referenciaA(Persona* p) {
+    RefPersona r = {-1, 0};
+    if (p == NULL || buscarPorID(p->id) != p) return r;
+    r.id = p->id;
+    r.version = almacenGlobal.bloques[p->id >> BITS_BLOQUE_ID][p->id & (TAM_BLOQUE_ID - 1)].version;
+    return r;
+}
+
+// Persona a la que apunta r, o NULL si es nula o qued vieja (la persona
+// fue eliminada, aunque su ID lo tenga ahora otra).
+Persona* resolverReferencia(RefPersona r) {
+    Persona* p = buscarPorID(r.id);
+    if (p == NULL || r.version == 0) return NULL;
+    return almacenGlobal.bloques[r.id >> BITS_BLOQUE_ID][r.id & (TAM_BLOQUE_ID - 1)].version == r.version ? p : NULL;
+}
+
+// =============================================================================
+// NDICE DE HIJOS
+// Relacin inversa de padre/madre: para cada ID, la lista de IDs de sus
+// hijos. Todas las listas viven una tras otra en un nico arreglo (estilo
+// CSR); cada ID guarda dnde empieza su tramo. Un tramo lleno se muda al
+// final con el doble de capacidad y cuando el espacio abandonado supera la
+// mitad del arreglo se compacta todo de nuevo.
+// =============================================================================
+struct TramoHijos {
+    int inicio;
+    int cantidad;
+    int capacidad;
+};
+
+struct IndiceHijos {
+    TramoHijos* tramos;     // Indexado por celda del progenitor
+    int numTramos;
+    int* hijos;             // IDs de hijos, tramo tras tramo
+    int usados;             // Posiciones ocupadas del arreglo (incluye desperdicio)
+    int capacidad;
+    int desperdicio;        // Posiciones de tramos mudados o vaciados
+    long enlaces;           // Total de pares progenitor-hijo
+};
+
+IndiceHijos indiceHijos = {NULL, 0, NULL, 0, 0, 0, 0};
+
+TramoHijos* tramoDe(int id) {
+    Persona* p = buscarPorID(id);
+    if (p == NULL || p->celda >= indiceHijos.numTramos) return NULL;
+    return &indiceHijos.tramos[p->celda];
+}
+
+int cantidadHijos(int id) {
+    TramoHijos* t = tramoDe(id);
+    return (t == NULL) ? 0 : t->cantidad;
+}
+
+// Puntero al primer hijo; vlido hasta la prxima modificacin del ndice.
+int* hijosDe(int id) {
+    TramoHijos* t = tramoDe(id);
+    return (t == NULL) ? NULL : indiceHijos.hijos + t->inicio;
+}
+
+void compactarIndiceHijos() {
+    int total = 0;
+    for (int i = 0; i < indiceHijos.numTramos; i++) {
+        total += indiceHijos.tramos[i].cantidad;
+    }
+    int nuevaCap = (total < 1024) ? 1024 : total * 2;
+    int* nuevos = new int[nuevaCap];
+    int pos = 0;
+    for (int i = 0; i < indiceHijos.numTramos; i++) {
+        TramoHijos &t = indiceHijos.tramos[i];
+        for (int k = 0; k < t.cantidad; k++) {
+            nuevos[pos + k] = indiceHijos.hijos[t.inicio + k];
+        }
+        t.inicio = pos;
+        t.capacidad = t.cantidad;
+        pos += t.cantidad;
+    }
+    delete[] indiceHijos.hijos;
+    indiceHijos.hijos = nuevos;
+    indiceHijos.usados = pos;
+    indiceHijos.capacidad = nuevaCap;
+    indiceHijos.desperdicio = 0;
+}
+
+// Reserva n posiciones al final del arreglo, compactando o ampliando si hace falta.
+int reservarEnIndiceHijos(int n) {
+    if (indiceHijos.usados + n > indiceHijos.capacidad) {
+        if (indiceHijos.desperdicio * 2 > indiceHijos.usados) {
+            compactarIndiceHijos();
+        }
+        if (indiceHijos.usados + n > indiceHijos.capacidad) {
+            int nuevaCap = (indiceHijos.capacidad == 0) ? 1024 : indiceHijos.capacidad * 2;
+            while (nuevaCap < indiceHijos.usados + n) nuevaCap *= 2;
+            int* nuevos = new int[nuevaCap];
+            for (int i = 0; i < indiceHijos.usados; i++) {
+                nuevos[i] = indiceHijos.hijos[i];
+            }
+            delete[] indiceHijos.hijos;
+            indiceHijos.hijos = nuevos;
+            indiceHijos.capacidad = nuevaCap;
+        }
+    }
+    int inicio = indiceHijos.usados;
+    indiceHijos.usados += n;
+    return inicio;
+}
+
+void agregarHijo(int progenitor, int hijo) {
+    Persona* pr = buscarPorID(progenitor);
+    if (pr == NULL) return;
+    int celda = pr->celda;
+    if (celda >= indiceHijos.numTramos) {
+        int nuevoTam = (indiceHijos.numTramos == 0) ? 1024 : indiceHijos.numTramos;
+        while (nuevoTam <= celda) nuevoTam *= 2;
+        TramoHijos* nuevos = new TramoHijos[nuevoTam];
+        for (int i = 0; i < nuevoTam; i++) {
+            if (i < indiceHijos.numTramos) {
+                nuevos[i] = indiceHijos.tramos[i];
+            } else {
+                nuevos[i].inicio = 0;
+                nuevos[i].cantidad = 0;
+                nuevos[i].capacidad = 0;
+            }
+        }
+        delete[] indiceHijos.tramos;
+        indiceHijos.tramos = nuevos;
+        indiceHijos.numTramos = nuevoTam;
+    }
+
+    TramoHijos* t = &indiceHijos.tramos[celda];
+    if (t->cantidad == t->capacidad) {
+        int nuevaCap = (t->capacidad == 0) ? 2 : t->capacidad * 2;
+        int inicio = reservarEnIndiceHijos(nuevaCap);
+        t = &indiceHijos.tramos[celda];         // La compactacin pudo mover el tramo
+        for (int k = 0; k < t->cantidad; k++) {
+            indiceHijos.hijos[inicio + k] = indiceHijos.hijos[t->inicio + k];
+        }
+        indiceHijos.desperdicio += t->capacidad;
+        t->inicio = inicio;
+        t->capacidad = nuevaCap;
+    }
+    indiceHijos.hijos[t->inicio + t->cantidad++] = hijo;
+    indiceHijos.enlaces++;
+}
+
+void quitarHijo(int progenitor, int hijo) {
+    TramoHijos* t = tramoDe(progenitor);
+    if (t == NULL) return;
+    int* lista = indiceHijos.hijos + t->inicio;
+    for (int k = 0; k < t->cantidad; k++) {
+        if (lista[k] == hijo) {
+            lista[k] = lista[--t->cantidad];
+            indiceHijos.enlaces--;
+            return;
+        }
+    }
+}
+
+// Vaca la lista de hijos de un ID (cuando la persona se elimina).
+void soltarHijos(int progenitor) {
+    TramoHijos* t = tramoDe(progenitor);
+    if (t == NULL) return;
+    indiceHijos.enlaces -= t->cantidad;
+    indiceHijos.desperdicio += t->capacidad;
+    t->cantidad = 0;
+    t->capacidad = 0;
+}
+
+void vaciarIndiceHijos() {
+    delete[] indiceHijos.tramos;
+    delete[] indiceHijos.hijos;
+    IndiceHijos vacio = {NULL, 0, NULL, 0, 0, 0, 0};
+    indiceHijos = vacio;
+}
+
+// Construye el ndice de cero en formato CSR compacto: cuenta los hijos de
+// cada progenitor, reparte los tramos por suma acumulada y los llena.
+void construirIndiceHijos(Persona** nodos, long n) {
+    vaciarIndiceHijos();
+    int limite = limiteCeldas();
+    indiceHijos.tramos = new TramoHijos[limite > 0 ? limite : 1];
+    indiceHijos.numTramos = limite;
+    for (int i = 0; i < limite; i++) {
+        indiceHijos.tramos[i].inicio = 0;
+        indiceHijos.tramos[i].cantidad = 0;
+        indiceHijos.tramos[i].capacidad = 0;
+    }
+
+    for (long i = 0; i < n; i++) {
+        Persona* p = nodos[i];
+        if (p->padre != NULL) indiceHijos.tramos[p->padre->celda].capacidad++;
+        if (p->madre != NULL && p->madre != p->padre) indiceHijos.tramos[p->madre->celda].capacidad++;
+    }
+    int total = 0;
+    for (int i = 0; i < limite; i++) {
+        indiceHijos.tramos[i].inicio = total;
+        total += indiceHijos.tramos[i].capacidad;
+    }
+    indiceHijos.capacidad = (total < 1024) ? 1024 : total;
+    indiceHijos.hijos = new int[indiceHijos.capacidad];
+    indiceHijos.usados = total;
+
+    for (long i = 0; i < n; i++) {
+        Persona* p = nodos[i];
+        if (p->padre != NULL) {
+            TramoHijos &t = indiceHijos.tramos[p->padre->celda];
+            indiceHijos.hijos[t.inicio + t.cantidad++] = p->id;
+        }
+        if (p->madre != NULL && p->madre != p->padre) {
+            TramoHijos &t = indiceHijos.tramos[p->madre->celda];
+            indiceHijos.hijos[t.inicio + t.cantidad++] = p->id;
+        }
+    }
+    indiceHijos.enlaces = total;
+}
+
+// =============================================================================
+// TABLA DE DATOS
+// Vista ordenada por ID que agregarPersona/quitarPersona mantienen al da,
+// as la pantalla de tabla no recorre el rbol. Como los IDs nuevos siempre
+// son los mayores, agregar es aadir al final. Quitar deja un hueco (NULL)
+// que se compacta cuando los huecos superan un cuarto de la tabla.
+// =============================================================================
+struct TablaPersonas {
+    Persona** personas;     // NULL en las filas eliminadas
+    int* ids;               // ID de cada fila (se conserva en los huecos)
+    int cantidad;           // Filas usadas, huecos incluidos
+    int capacidad;
+    int huecos;
+};
+
+TablaPersonas tablaGlobal = {NULL, NULL, 0, 0, 0};
+
+void inicializarTabla() {
+    delete[] tablaGlobal.personas;
+    delete[] tablaGlobal.ids;
+    tablaGlobal.personas = NULL;
+    tablaGlobal.ids = NULL;
+    tablaGlobal.cantidad = 0;
+    tablaGlobal.capacidad = 0;
+    tablaGlobal.huecos = 0;
+}
+
+void ampliarTabla() {
+    int nuevaCap = (tablaGlobal.capacidad == 0) ? 64 : tablaGlobal.capacidad * 2;
+    Persona** personas = new Persona*[nuevaCap];
+    int* ids = new int[nuevaCap];
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        personas[i] = tablaGlobal.personas[i];
+        ids[i] = tablaGlobal.ids[i];
+    }
+    delete[] tablaGlobal.personas;
+    delete[] tablaGlobal.ids;
+    tablaGlobal.personas = personas;
+    tablaGlobal.ids = ids;
+    tablaGlobal.capacidad = nuevaCap;
+}
+
+// Primera fila con ID >= id.
+int posicionEnTabla(int id) {
+    int inicio = 0, fin = tablaGlobal.cantidad;
+    while (inicio < fin) {
+        int medio = (inicio + fin) / 2;
+        if (tablaGlobal.ids[medio] < id) inicio = medio + 1;
+        else fin = medio;
+    }
+    return inicio;
+}
+
+void compactarTabla() {
+    int destino = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        if (tablaGlobal.personas[i] != NULL) {
+            tablaGlobal.personas[destino] = tablaGlobal.personas[i];
+            tablaGlobal.ids[destino] = tablaGlobal.ids[i];
+            destino++;
+        }
+    }
+    tablaGlobal.cantidad = destino;
+    tablaGlobal.huecos = 0;
+}
+
+void agregarATabla(Persona* p) {
+    if (p == NULL) return;
+    if (tablaGlobal.cantidad == tablaGlobal.capacidad) ampliarTabla();
+
+    int pos = tablaGlobal.cantidad;
+    if (pos > 0 && tablaGlobal.ids[pos - 1] >= p->id) {
+        pos = posicionEnTabla(p->id);
+        if (pos < tablaGlobal.cantidad && tablaGlobal.ids[pos] == p->id) {
+            if (tablaGlobal.personas[pos] == NULL) tablaGlobal.huecos--;
+            tablaGlobal.personas[pos] = p;
+            return;
+        }
+        for (int i = tablaGlobal.cantidad; i > pos; i--) {
+            tablaGlobal.personas[i] = tablaGlobal.personas[i - 1];
+            tablaGlobal.ids[i] = tablaGlobal.ids[i - 1];
+        }
+    }
+    tablaGlobal.personas[pos] = p;
+    tablaGlobal.ids[pos] = p->id;
+    tablaGlobal.cantidad++;
+}
+
+void quitarDeTabla(int id) {
+    int pos = posicionEnTabla(id);
+    if (pos == tablaGlobal.cantidad || tablaGlobal.ids[pos] != id || tablaGlobal.personas[pos] == NULL) return;
+
+    tablaGlobal.personas[pos] = NULL;
+    tablaGlobal.huecos++;
+    if (tablaGlobal.huecos * 4 > tablaGlobal.cantidad) compactarTabla();
+}
+
+bool agregarFilaATabla(Persona* p) {
+    agregarATabla(p);
+    return true;
+}
+
+void llenarTabla(Persona* raiz) {
+    recorrerInorden(raiz, agregarFilaATabla);
+}
+
+// =============================================================================
+// NDICE DE NOMBRES
+// rbol de prefijos compacto (radix) sobre los nombres plegados: minsculas,
+// sin acentos (Latin-1 o UTF-8) y con los espacios repetidos reducidos a uno.
+// Cada palabra del nombre entra como clave desde donde empieza, as "garc"
+// encuentra a "Juan Garca"; la clave de la primera palabra es el nombre
+// completo y es la que usan las bsquedas exactas. Cada arista apunta al
+// tramo de clave que no comparte con sus hermanas, guardado una sola vez en
+// el montculo de cadenas. Buscar cuesta O(|texto| + resultados).
+// Las entradas de cada nodo forman una lista doble y las de cada persona se
+// encadenan desde una tabla por celda, as quitar un nombre cuesta O(palabras)
+// aunque miles de personas compartan el apellido; las hojas que quedan sin
+// entradas se podan y sus nodos se reciclan.
+// =============================================================================
+enum ModoNombre { NOMBRE_EXACTO, NOMBRE_PLEGADO, NOMBRE_PREFIJO };
+
+struct NodoNombre {
+    const char* etiqueta;   // Tramo de clave plegada de la arista que llega aqu
+    int largo;
+    int padre;
+    int primerHijo;         // Hijos ordenados por su primer byte; -1 = ninguno
+    int hermano;            // En los nodos libres encadena la lista libre
+    int primeraEntrada;     // Entradas cuya clave termina en este nodo
+};
+
+struct EntradaNombre {
+    int id;
+    int palabra;            // 0 = la clave es el nombre completo
+    int nodo;               // Nodo donde termina la clave
+    int anterior;           // Lista doble de las entradas del nodo
+    int siguiente;          // -1 = fin; tambin encadena las entradas libres
+    int siguienteDePersona; // Prxima palabra de la misma persona
+};
+
+struct IndiceNombres {
+    NodoNombre* nodos;      // nodos[0] es la raz
+    int numNodos;
+    int capacidadNodos;
+    int nodoLibre;
+    int nodosLibres;
+    EntradaNombre* entradas;
+    int numEntradas;
+    int capacidadEntradas;
+    int entradaLibre;
+    long claves;            // Entradas vivas (una por palabra de cada nombre)
+    int* entradasDe;        // Por celda: primera entrada de la persona, -1 = ninguna
+    int capacidadPersonas;
+};
+
+IndiceNombres indiceNombres = {NULL, 0, 0, -1, 0, NULL, 0, 0, -1, 0, NULL, 0};
+
+unsigned char tablaPlegado[256];
+bool tablaPlegadoLista = false;
+char* textoPlegado = NULL;
+int capacidadPlegado = 0;
+
+void prepararPlegado() {
+    for (int c = 0; c < 256; c++) tablaPlegado[c] = (unsigned char)c;
+    for (int c = 'A'; c <= 'Z'; c++) tablaPlegado[c] = (unsigned char)(c + 32);
+    tablaPlegado['\t'] = ' ';
+    // Latin-1 0xC0-0xDF (maysculas) y 0xE0-0xFF (minsculas); '.' = sin base.
+    const char* sinAcento = "aaaaaa.ceeeeiiii.nooooo.ouuuuy..";
+    for (int i = 0; i < 32; i++) {
+        if (sinAcento[i] != '.') {
+            tablaPlegado[0xC0 + i] = (unsigned char)sinAcento[i];
+            tablaPlegado[0xE0 + i] = (unsigned char)sinAcento[i];
+        } else if (i != 0x17 && i != 0x1F) {
+            tablaPlegado[0xC0 + i] = (unsigned char)(0xE0 + i);
+        }
+    }
+    tablaPlegado[0xFF] = 'y';
+    tablaPlegadoLista = true;
+}
+
+// Deja en textoPlegado el texto plegado, sin espacios al principio ni al
+// final. Las secuencias UTF-8 de dos bytes del rango Latin-1 (C2/C3 xx) se
+// leen como su carcter Latin-1, as da igual cmo se tecle el nombre.
+// RETORNO: largo del texto plegado.
+int plegarNombre(const char* texto, int largo) {
+    if (!tablaPlegadoLista) prepararPlegado();
+    if (largo + 1 > capacidadPlegado) {
+        delete[] textoPlegado;
+        capacidadPlegado = (largo + 1 > 256) ? largo + 1 : 256;
+        textoPlegado = new char[capacidadPlegado];
+    }
+    int n = 0;
+    for (int i = 0; i < largo; i++) {
+        unsigned char c = (unsigned char)texto[i];
+        if ((c == 0xC2 || c == 0xC3) && i + 1 < largo && ((unsigned char)texto[i + 1] & 0xC0) == 0x80) {
+            c = (unsigned char)(((c & 0x03) << 6) | ((unsigned char)texto[++i] & 0x3F));
+        }
+        c = tablaPlegado[c];
+        if (c == ' ' && (n == 0 || textoPlegado[n - 1] == ' ')) continue;
+        textoPlegado[n++] = (char)c;
+    }
+    while (n > 0 && textoPlegado[n - 1] == ' ') n--;
+    textoPlegado[n] = '\0';
+    return n;
+}
+
+int nuevoNodoNombre(const char* etiqueta, int largo, int padre) {
+    IndiceNombres &ix = indiceNombres;
+    if (ix.nodoLibre >= 0) {
+        int libre = ix.nodoLibre;
+        ix.nodoLibre = ix.nodos[libre].hermano;
+        ix.nodosLibres--;
+        NodoNombre &n = ix.nodos[libre];
+        n.etiqueta = etiqueta;
+        n.largo = largo;
+        n.padre = padre;
+        n.primerHijo = -1;
+        n.hermano = -1;
+        n.primeraEntrada = -1;
+        return libre;
+    }
+    if (ix.numNodos == ix.capacidadNodos) {
+        int nuevaCap = (ix.capacidadNodos == 0) ? 1024 : ix.capacidadNodos * 2;
+        NodoNombre* nuevos = new NodoNombre[nuevaCap];
+        for (int i = 0; i < ix.numNodos; i++) {
+            nuevos[i] = ix.nodos[i];
+        }
+        delete[] ix.nodos;
+        ix.nodos = nuevos;
+        ix.capacidadNodos = nuevaCap;
+    }
+    NodoNombre &n = ix.nodos[ix.numNodos];
+    n.etiqueta = etiqueta;
+    n.largo = largo;
+    n.padre = padre;
+    n.primerHijo = -1;
+    n.hermano = -1;
+    n.primeraEntrada = -1;
+    return ix.numNodos++;
+}
+
+// Hijo de nodo cuya etiqueta empieza con c; -1 si no hay.
+int hijoNombre(int nodo, char c) {
+    NodoNombre* nodos = indiceNombres.nodos;
+    for (int h = nodos[nodo].primerHijo; h >= 0; h = nodos[h].hermano) {
+        unsigned char primero = (unsigned char)nodos[h].etiqueta[0];
+        if (primero == (unsigned char)c) return h;
+        if (primero > (unsigned char)c) return -1;
+    }
+    return -1;
+}
+
+void enlazarHijoNombre(int padre, int hijo) {
+    NodoNombre* nodos = indiceNombres.nodos;
+    unsigned char c = (unsigned char)nodos[hijo].etiqueta[0];
+    int* enlace = &nodos[padre].primerHijo;
+    while (*enlace >= 0 && (unsigned char)nodos[*enlace].etiqueta[0] < c) {
+        enlace = &nodos[*enlace].hermano;
+    }
+    nodos[hijo].hermano = *enlace;
+    *enlace = hijo;
+}
+
+// Saca el nodo hijo de la lista de hijos de su padre.
+void desenlazarHijoNombre(int hijo) {
+    NodoNombre* nodos = indiceNombres.nodos;
+    int* enlace = &nodos[nodos[hijo].padre].primerHijo;
+    while (*enlace != hijo) enlace = &nodos[*enlace].hermano;
+    *enlace = nodos[hijo].hermano;
+}
+
+// Tabla de entradas por persona, indexada por celda.
+void prepararEntradasDe(int celda) {
+    IndiceNombres &ix = indiceNombres;
+    if (celda < ix.capacidadPersonas) return;
+    int nuevaCap = (ix.capacidadPersonas == 0) ? 1024 : ix.capacidadPersonas;
+    while (nuevaCap <= celda) nuevaCap *= 2;
+    int* nuevas = new int[nuevaCap];
+    for (int i = 0; i < ix.capacidadPersonas; i++) nuevas[i] = ix.entradasDe[i];
+    for (int i = ix.capacidadPersonas; i < nuevaCap; i++) nuevas[i] = -1;
+    delete[] ix.entradasDe;
+    ix.entradasDe = nuevas;
+    ix.capacidadPersonas = nuevaCap;
+}
+
+void agregarClaveNombre(const char* clave, int largo, Persona* p, int palabra) {
+    IndiceNombres &ix = indiceNombres;
+    if (ix.numNodos == 0) nuevoNodoNombre(NULL, 0, -1);
+
+    int nodo = 0, pos = 0;
+    while (pos < largo) {
+        int h = hijoNombre(nodo, clave[pos]);
+        if (h < 0) {
+            Cadena resto = guardarCadena(clave + pos, largo - pos);
+            h = nuevoNodoNombre(resto.datos, resto.largo, nodo);
+            enlazarHijoNombre(nodo, h);
+            nodo = h;
+            break;
+        }
+        const char* etiqueta = ix.nodos[h].etiqueta;
+        int largoEtiqueta = ix.nodos[h].largo;
+        int comun = 1;
+        while (comun < largoEtiqueta && pos + comun < largo && etiqueta[comun] == clave[pos + comun]) comun++;
+        if (comun < largoEtiqueta) {
+            // Parte la arista: un nodo nuevo toma el lugar de h con el tramo
+            // comn y h cuelga de l con el resto. As h conserva sus hijos y
+            // sus entradas, que siguen apuntando a l.
+            int arriba = nuevoNodoNombre(etiqueta, comun, nodo);
+            int* enlace = &ix.nodos[nodo].primerHijo;
+            while (*enlace != h) enlace = &ix.nodos[*enlace].hermano;
+            *enlace = arriba;
+            ix.nodos[arriba].hermano = ix.nodos[h].hermano;
+            ix.nodos[arriba].primerHijo = h;
+            ix.nodos[h].hermano = -1;
+            ix.nodos[h].padre = arriba;
+            ix.nodos[h].etiqueta = etiqueta + comun;
+            ix.nodos[h].largo = largoEtiqueta - comun;
+            h = arriba;
+        }
+        nodo = h;
+        pos += comun;
+    }
+
+    int e = ix.entradaLibre;
+    if (e >= 0) {
+        ix.entradaLibre = ix.entradas[e].siguiente;
+    } else {
+        if (ix.numEntradas == ix.capacidadEntradas) {
+            int nuevaCap = (ix.capacidadEntradas == 0) ? 1024 : ix.capacidadEntradas * 2;
+            EntradaNombre* nuevas = new EntradaNombre[nuevaCap];
+            for (int i = 0; i < ix.numEntradas; i++) {
+                nuevas[i] = ix.entradas[i];
+            }
+            delete[] ix.entradas;
+            ix.entradas = nuevas;
+            ix.capacidadEntradas = nuevaCap;
+        }
+        e = ix.numEntradas++;
+    }
+    EntradaNombre &en = ix.entradas[e];
+    en.id = p->id;
+    en.palabra = palabra;
+    en.nodo = nodo;
+    en.anterior = -1;
+    en.siguiente = ix.nodos[nodo].primeraEntrada;
+    if (en.siguiente >= 0) ix.entradas[en.siguiente].anterior = e;
+    ix.nodos[nodo].primeraEntrada = e;
+    prepararEntradasDe(p->celda);
+    en.siguienteDePersona = ix.entradasDe[p->celda];
+    ix.entradasDe[p->celda] = e;
+    ix.claves++;
+}
+
+// Nodo donde termina la clave; -1 si no est. Con prefijo = true tambin
+// vale terminar a mitad de una arista: se devuelve el nodo al que lleva.
+int ubicarClaveNombre(const char* clave, int largo, bool prefijo) {
+    if (indiceNombres.numNodos == 0) return -1;
+    NodoNombre* nodos = indiceNombres.nodos;
+    int nodo = 0, pos = 0;
+    while (pos < largo) {
+        int h = hijoNombre(nodo, clave[pos]);
+        if (h < 0) return -1;
+        int resto = largo - pos;
+        int k = (nodos[h].largo < resto) ? nodos[h].largo : resto;
+        if (memcmp(nodos[h].etiqueta, clave + pos, k) != 0) return -1;
+        if (k < nodos[h].largo) return prefijo ? h : -1;
+        nodo = h;
+        pos += k;
+    }
+    return nodo;
+}
+
+// Desengancha la entrada e de su nodo en O(1) y poda hacia arriba los nodos
+// que quedan sin entradas ni hijos (la raz nunca se poda).
+void quitarEntradaNombre(int e) {
+    IndiceNombres &ix = indiceNombres;
+    EntradaNombre &en = ix.entradas[e];
+    if (en.anterior >= 0) ix.entradas[en.anterior].siguiente = en.siguiente;
+    else ix.nodos[en.nodo].primeraEntrada = en.siguiente;
+    if (en.siguiente >= 0) ix.entradas[en.siguiente].anterior = en.anterior;
+
+    int nodo = en.nodo;
+    while (nodo > 0 && ix.nodos[nodo].primeraEntrada < 0 && ix.nodos[nodo].primerHijo < 0) {
+        int padre = ix.nodos[nodo].padre;
+        desenlazarHijoNombre(nodo);
+        ix.nodos[nodo].hermano = ix.nodoLibre;
+        ix.nodoLibre = nodo;
+        ix.nodosLibres++;
+        nodo = padre;
+    }
+
+    en.siguiente = ix.entradaLibre;
+    ix.entradaLibre = e;
+    ix.claves--;
+}
+
+// Agrega una clave por cada palabra del nombre de p.
+void indexarNombre(Persona* p) {
+    int n = plegarNombre(p->nombre.datos, p->nombre.largo);
+    int palabra = 0;
+    for (int i = 0; i < n; i++) {
+        if (i > 0 && textoPlegado[i - 1] != ' ') continue;
+        agregarClaveNombre(textoPlegado + i, n - i, p, palabra);
+        palabra++;
+    }
+}
+
+// Quita las claves de p siguiendo su cadena de entradas: no hace falta
+// volver a plegar el nombre ni buscar las claves en el rbol.
+void desindexarNombre(Persona* p) {
+    IndiceNombres &ix = indiceNombres;
+    if (p->celda >= ix.capacidadPersonas) return;
+    int e = ix.entradasDe[p->celda];
+    while (e >= 0) {
+        int siguiente = ix.entradas[e].siguienteDePersona;
+        quitarEntradaNombre(e);
+        e = siguiente;
+    }
+    ix.entradasDe[p->celda] = -1;
+}
+
+void vaciarIndiceNombres() {
+    delete[] indiceNombres.nodos;
+    delete[] indiceNombres.entradas;
+    delete[] indiceNombres.entradasDe;
+    IndiceNombres vacio = {NULL, 0, 0, -1, 0, NULL, 0, 0, -1, 0, NULL, 0};
+    indiceNombres = vacio;
+}
+
+long bytesIndiceNombres() {
+    return (long)indiceNombres.capacidadNodos * sizeof(NodoNombre)
+         + (long)indiceNombres.capacidadEntradas * sizeof(EntradaNombre)
+         + (long)indiceNombres.capacidadPersonas * sizeof(int);
+}
+
+MarcasVisita marcasNombres;
+
+// Agrega a resultado los IDs de quienes coinciden con texto, cada uno una vez:
+//   NOMBRE_EXACTO : el nombre completo, byte a byte.
+//   NOMBRE_PLEGADO: el nombre completo sin distinguir maysculas ni acentos.
+//   NOMBRE_PREFIJO: alguna palabra del nombre empieza por texto (plegado);
+//                   salen en orden alfabtico de la palabra encontrada.
+// RETORNO: cantidad de IDs agregados.
+int buscarPorNombre(const char* texto, int largo, ModoNombre modo, ListaEnteros &resultado) {
+    int n = plegarNombre(texto, largo);
+    if (n == 0) return 0;
+    int nodo = ubicarClaveNombre(textoPlegado, n, modo == NOMBRE_PREFIJO);
+    if (nodo < 0) return 0;
+
+    NodoNombre* nodos = indiceNombres.nodos;
+    EntradaNombre* entradas = indiceNombres.entradas;
+    int antes = resultado.cantidad;
+    if (modo != NOMBRE_PREFIJO) {
+        for (int e = nodos[nodo].primeraEntrada; e >= 0; e = entradas[e].siguiente) {
+            if (entradas[e].palabra != 0) continue;
+            Persona* p = buscarPorID(entradas[e].id);
+            if (modo == NOMBRE_EXACTO && (p->nombre.largo != largo || memcmp(p->nombre.datos, texto, largo) != 0)) {
+                continue;
+            }
+            agregarEntero(resultado, p->id);
+        }
+        return resultado.cantidad - antes;
+    }
+
+    // Preorden del subrbol: al sacar un nodo se apila su hermano y encima su
+    // primer hijo, as la pila nunca supera la profundidad.
+    nuevaVisita(marcasNombres, limiteCeldas());
+    ListaEnteros pila;
+    inicializarEnteros(pila);
+    agregarEntero(pila, nodo);
+    bool primero = true;
+    while (pila.cantidad > 0) {
+        int actual = pila.datos[--pila.cantidad];
+        for (int e = nodos[actual].primeraEntrada; e >= 0; e = entradas[e].siguiente) {
+            Persona* p = buscarPorID(entradas[e].id);
+            if (p != NULL && marcarVisitado(marcasNombres, p->celda)) agregarEntero(resultado, p->id);
+        }
+        if (!primero && nodos[actual].hermano >= 0) agregarEntero(pila, nodos[actual].hermano);
+        if (nodos[actual].primerHijo >= 0) agregarEntero(pila, nodos[actual].primerHijo);
+        primero = false;
+    }
+    liberarEnteros(pila);
+    return resultado.cantidad - antes;
+}
+
+// =============================================================================
+// NDICE POR FECHA DE NACIMIENTO
+// Un segundo AVL, ordenado por (fecha, id) y con el tamao de cada subrbol:
+// contar los nacidos en un rango cuesta O(log n) y recorrerlos O(log n + k),
+// ya en orden cronolgico. Los nodos viven en un arreglo, se enlazan por
+// ndice y los eliminados se reciclan. Las fechas desconocidas (valor 0)
+// quedan al principio y no entran en ningn rango que empiece despus.
+// =============================================================================
+struct NodoFecha {
+    unsigned int fecha;     // Fecha::valor
+    int id;
+    int izq;                // -1 = vaco; en los nodos libres encadena la lista libre
+    int der;
+    int altura;
+    int tamano;             // Nodos del subrbol
+};
+
+struct IndiceFechas {
+    NodoFecha* nodos;
+    int usados;
+    int capacidad;
+    int libre;
+    int raiz;
+};
+
+IndiceFechas indiceFechas = {NULL, 0, 0, -1, -1};
+
+const Fecha FECHA_MAXIMA = {0xFFFFFFFEu};
+
+int alturaFecha(int i) {
+    return (i < 0) ? 0 : indiceFechas.nodos[i].altura;
+}
+
+int tamanoFecha(int i) {
+    return (i < 0) ? 0 : indiceFechas.nodos[i].tamano;
+}
+
+void actualizarNodoFecha(int i) {
+    NodoFecha &n = indiceFechas.nodos[i];
+    int hi = alturaFecha(n.izq), hd = alturaFecha(n.der);
+    n.altura = (hi > hd ? hi : hd) + 1;
+    n.tamano = tamanoFecha(n.izq) + tamanoFecha(n.der) + 1;
+}
+
+bool claveFechaMenor(unsigned int fechaA, int idA, unsigned int fechaB, int idB) {
+    return fechaA < fechaB || (fechaA == fechaB && idA < idB);
+}
+
+int rotarDerechaFecha(int y) {
+    NodoFecha* nodos = indiceFechas.nodos;
+    int x = nodos[y].izq;
+    nodos[y].izq = nodos[x].der;
+    nodos[x].der = y;
+    actualizarNodoFecha(y);
+    actualizarNodoFecha(x);
+    return x;
+}
+
+int rotarIzquierdaFecha(int x) {
+    NodoFecha* nodos = indiceFechas.nodos;
+    int y = nodos[x].der;
+    nodos[x].der = nodos[y].izq;
+    nodos[y].izq = x;
+    actualizarNodoFecha(x);
+    actualizarNodoFecha(y);
+    return y;
+}
+
+int balancearFecha(int i) {
+    NodoFecha* nodos = indiceFechas.nodos;
+    actualizarNodoFecha(i);
+    int factor = alturaFecha(nodos[i].izq) - alturaFecha(nodos[i].der);
+    if (factor > 1) {
+        int h = nodos[i].izq;
+        if (alturaFecha(nodos[h].izq) < alturaFecha(nodos[h].der)) nodos[i].izq = rotarIzquierdaFecha(h);
+        return rotarDerechaFecha(i);
+    }
+    if (factor < -1) {
+        int h = nodos[i].der;
+        if (alturaFecha(nodos[h].der) < alturaFecha(nodos[h].izq)) nodos[i].der = rotarDerechaFecha(h);
+        return rotarIzquierdaFecha(i);
+    }
+    return i;
+}
+
+// A diferencia del ndice por ID no se corta al conservar la altura: los
+// tamaos de todo el camino cambian.
+void rebalancearCaminoFechas(int* camino[], int largo) {
+    while (largo > 0) {
+        int* enlace = camino[--largo];
+        *enlace = balancearFecha(*enlace);
+    }
+}
+
+int nuevoNodoFecha(unsigned int fecha, int id) {
+    IndiceFechas &ix = indiceFechas;
+    int i = ix.libre;
+    if (i >= 0) {
+        ix.libre = ix.nodos[i].izq;
+    } else {
+        if (ix.usados == ix.capacidad) {
+            int nuevaCap = (ix.capacidad == 0) ? 1024 : ix.capacidad * 2;
+            NodoFecha* nuevos = new NodoFecha[nuevaCap];
+            for (int k = 0; k < ix.usados; k++) {
+                nuevos[k] = ix.nodos[k];
+            }
+            delete[] ix.nodos;
+            ix.nodos = nuevos;
+            ix.capacidad = nuevaCap;
+        }
+        i = ix.usados++;
+    }
+    NodoFecha &n = ix.nodos[i];
+    n.fecha = fecha;
+    n.id = id;
+    n.izq = -1;
+    n.der = -1;
+    n.altura = 1;
+    n.tamano = 1;
+    return i;
+}
+
+void agregarAFechas(Persona* p) {
+    unsigned int fecha = p->fecha_nac.valor;
+    int nuevo = nuevoNodoFecha(fecha, p->id);     // Antes de tomar punteros al arreglo
+    NodoFecha* nodos = indiceFechas.nodos;
+
+    int* camino[MAX_ALTURA_AVL];
+    int largo = 0;
+    int* enlace = &indiceFechas.raiz;
+    while (*enlace >= 0) {
+        camino[largo++] = enlace;
+        NodoFecha &n = nodos[*enlace];
+        enlace = claveFechaMenor(fecha, p->id, n.fecha, n.id) ? &n.izq : &n.der;
+    }
+    *enlace = nuevo;
+    rebalancearCaminoFechas(camino, largo);
+}
+
+void quitarDeFechas(Persona* p) {
+    unsigned int fecha = p->fecha_nac.valor;
+    NodoFecha* nodos = indiceFechas.nodos;
+
+    int* camino[MAX_ALTURA_AVL];
+    int largo = 0;
+    int* enlace = &indiceFechas.raiz;
+    while (*enlace >= 0 && !(nodos[*enlace].fecha == fecha && nodos[*enlace].id == p->id)) {
+        camino[largo++] = enlace;
+        NodoFecha &n = nodos[*enlace];
+        enlace = claveFechaMenor(fecha, p->id, n.fecha, n.id) ? &n.izq : &n.der;
+    }
+    if (*enlace < 0) return;
+
+    int objetivo = *enlace;
+    if (nodos[objetivo].izq < 0) {
+        *enlace = nodos[objetivo].der;
+    } else if (nodos[objetivo].der < 0) {
+        *enlace = nodos[objetivo].izq;
+    } else {
+        // Igual que en eliminar: el sucesor se reenlaza en el lugar del nodo.
+        int posObjetivo = largo;
+        camino[largo++] = enlace;
+
+        int* e = &nodos[objetivo].der;
+        while (nodos[*e].izq >= 0) {
+            camino[largo++] = e;
+            e = &nodos[*e].izq;
+        }
+        int sucesor = *e;
+        *e = nodos[sucesor].der;
+        nodos[sucesor].izq = nodos[objetivo].izq;
+        nodos[sucesor].der = nodos[objetivo].der;
+        *enlace = sucesor;
+
+        if (largo > posObjetivo + 1) {
+            camino[posObjetivo + 1] = &nodos[sucesor].der;
+        }
+    }
+
+    nodos[objetivo].izq = indiceFechas.libre;
+    indiceFechas.libre = objetivo;
+    rebalancearCaminoFechas(camino, largo);
+}
+
+void vaciarIndiceFechas() {
+    delete[] indiceFechas.nodos;
+    IndiceFechas vacio = {NULL, 0, 0, -1, -1};
+    indiceFechas = vacio;
+}
+
+int compararNodosFecha(const void* a, const void* b) {
+    const NodoFecha* x = (const NodoFecha*)a;
+    const NodoFecha* y = (const NodoFecha*)b;
+    if (claveFechaMenor(x->fecha, x->id, y->fecha, y->id)) return -1;
+    return claveFechaMenor(y->fecha, y->id, x->fecha, x->id) ? 1 : 0;
+}
+
+int enlazarFechasBalanceado(int inicio, int fin) {
+    if (inicio > fin) return -1;
+    int medio = inicio + (fin - inicio) / 2;
+    NodoFecha* nodos = indiceFechas.nodos;
+    nodos[medio].izq = enlazarFechasBalanceado(inicio, medio - 1);
+    nodos[medio].der = enlazarFechasBalanceado(medio + 1, fin);
+    actualizarNodoFecha(medio);
+    return medio;
+}
+
+// Reconstruye el ndice de cero (importacin e instantnea): ordena las
+// claves una vez y arma el rbol balanceado en O(n log n).
+void construirIndiceFechas(Persona** personas, long n) {
+    vaciarIndiceFechas();
+    indiceFechas.capacidad = (n < 1024) ? 1024 : (int)n;
+    indiceFechas.nodos = new NodoFecha[indiceFechas.capacidad];
+    for (long i = 0; i < n; i++) {
+        nuevoNodoFecha(personas[i]->fecha_nac.valor, personas[i]->id);
+    }
+    qsort(indiceFechas.nodos, n, sizeof(NodoFecha), compararNodosFecha);
+    indiceFechas.raiz = enlazarFechasBalanceado(0, (int)n - 1);
+}
+
+// Cantidad de claves menores que (fecha, id).
+long rangoFecha(unsigned int fecha, int id) {
+    NodoFecha* nodos = indiceFechas.nodos;
+    long rango = 0;
+    int i = indiceFechas.raiz;
+    while (i >= 0) {
+        if (claveFechaMenor(nodos[i].fecha, nodos[i].id, fecha, id)) {
+            rango += tamanoFecha(nodos[i].izq) + 1;
+            i = nodos[i].der;
+        } else {
+            i = nodos[i].izq;
+        }
+    }
+    return rango;
+}
+
+// Nacidos entre desde y hasta, ambos incluidos. Los IDs nunca son negativos,
+// as (fecha, -1) queda antes que cualquier persona nacida ese da.
+long contarNacidos(Fecha desde, Fecha hasta) {
+    if (hasta < desde) return 0;
+    return rangoFecha(hasta.valor + 1, -1) - rangoFecha(desde.valor, -1);
+}
+
+// Visita en orden cronolgico (y por ID dentro del mismo da) a los nacidos
+// entre desde y hasta, como mucho maximo (0 = todos). visitar no debe
+// agregar ni quitar personas.
+// RETORNO: cantidad de personas visitadas.
+long recorrerNacidos(Fecha desde, Fecha hasta, VisitaPersona visitar, long maximo = 0) {
+    NodoFecha* nodos = indiceFechas.nodos;
+    ListaEnteros pila;
+    inicializarEnteros(pila);
+    long visitados = 0;
+    int i = indiceFechas.raiz;
+    while (maximo == 0 || visitados < maximo) {
+        while (i >= 0) {
+            if (nodos[i].fecha < desde.valor) {
+                i = nodos[i].der;       // Todo el subrbol izquierdo es anterior
+            } else {
+                agregarEntero(pila, i);
+                i = nodos[i].izq;
+            }
+        }
+        if (pila.cantidad == 0) break;
+        i = pila.datos[--pila.cantidad];
+        if (nodos[i].fecha > hasta.valor) break;
+        visitados++;
+        if (!visitar(buscarPorID(nodos[i].id))) break;
+        i = nodos[i].der;
+    }
+    liberarEnteros(pila);
+    return visitados;
+}
+
+// Lmite de un rango: "dd/mm/aaaa", un ao solo (el 1 de enero o, si final
+// es true, el 31 de diciembre) o "-" para dejarlo abierto. Un rango abierto
+// por abajo empieza en la primera fecha conocida.
+// RETORNO: false si el texto no es ninguna de esas formas.
+bool leerLimiteFecha(const char* texto, bool final, Fecha &f) {
+    if (strcmp(texto, "-") == 0) {
+        f.valor = final ? FECHA_MAXIMA.valor : 1;
+        return true;
+    }
+    if (parsearFecha(texto, f)) return true;
+    int largo = (int)strlen(texto);
+    if (largo == 0 || largo > 6) return false;
+    for (int i = 0; i < largo; i++) {
+        if (texto[i] < '0' || texto[i] > '9') return false;
+    }
+    int anio = atoi(texto);
+    f = final ? empaquetarFecha(31, 12, anio) : empaquetarFecha(1, 1, anio);
+    return true;
+}
+
+// =============================================================================
+// REGISTRO DE OPERACIONES (WAL)
+// Cada alta y baja se anexa a un archivo de registro antes de volver al
+// llamador; al arrancar se reaplica sobre la instantnea lo que sta todava
+// no contiene. Cada registro en disco es una CabeceraOperacion seguida del
+// nombre. El CRC cubre todo lo que sigue al propio campo, as una escritura
+// cortada por una cada se detecta y la cola rota se descarta.
+// Sincronizacin con el disco (fsync):
+//   SYNC_SIEMPRE: cada operacin espera a que llegue al disco.
+//   SYNC_GRUPO  : un hilo sincroniza cada intervaloMs todo lo escrito hasta
+//                 ese momento; un corte de luz pierde como mucho ese lapso.
+//   SYNC_NUNCA  : queda en manos del sistema operativo.
+// En los tres casos la escritura ya se entreg al sistema, as que si slo
+// se cae el programa no se pierde nada.
+// =============================================================================
+const char* ARCHIVO_REGISTRO = "arbol.wal";
+
+enum PoliticaSync { SYNC_SIEMPRE, SYNC_GRUPO, SYNC_NUNCA };
+enum TipoOperacion { OPERACION_ALTA = 1, OPERACION_BAJA = 2, OPERACION_PADRES = 3 };
+
+PoliticaSync politicaSync = SYNC_GRUPO;
+int intervaloSyncMs = 5;
+
+struct CabeceraOperacion {
+    unsigned int crc;
+    unsigned int largo;             // Bytes del registro completo, nombre incluido
+    long long secuencia;
+    int tipo;
+    int id;
+    unsigned int fecha;             // Fecha::valor
+    int padre;                      // ID, -1 si no tiene
+    int madre;
+    int largoNombre;
+};
+
+struct RegistroOperaciones {
+    bool abierto;                   // false: no se anota nada
+    int fd;
+    PoliticaSync politica;
+    int intervaloMs;
+    long long secuencia;            // ltima operacin anotada o reaplicada
+    bool reaplicando;               // Durante la reaplicacin no se vuelve a anotar
+    char* buffer;
+    int capacidadBuffer;
+    long operaciones;
+    long sincronizaciones;
+    long errores;
+    bool pendiente;                 // Hay escrituras sin fsync (modo grupo)
+    bool sinAnotar;                 // Hay cambios en memoria que no llegaron al registro
+    bool activo;                    // El hilo de grupo sigue corriendo
+    mutex cerrojo;
+    condition_variable aviso;
+    thread hiloGrupo;
+};
+
+RegistroOperaciones registroOps;
+
+unsigned int tablaCRC[256];
+bool tablaCRCLista = false;
+
+// CRC-32 (polinomio 0xEDB88320, el de zip/PNG) con tabla de 256 entradas.
+unsigned int calcularCRC32(const char* datos, size_t n) {
+    if (!tablaCRCLista) {
+        for (unsigned int i = 0; i < 256; i++) {
+            unsigned int c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            tablaCRC[i] = c;
+        }
+        tablaCRCLista = true;
+    }
+    unsigned int c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < n; i++) {
+        c = tablaCRC[(c ^ (unsigned char)datos[i]) & 0xFF] ^ (c >> 8);
+    }
+    return c ^ 0xFFFFFFFFu;
+}
+
+#ifndef _WIN32
+int abrirParaAnexar(const char* ruta) {
+    return open(ruta, O_WRONLY | O_CREAT | O_APPEND, 0644);
+}
+
+bool escribirTodo(int fd, const char* datos, size_t n) {
+    while (n > 0) {
+        ssize_t escritos = write(fd, datos, n);
+        if (escritos < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        datos += escritos;
+        n -= escritos;
+    }
+    return true;
+}
+
+void sincronizarDisco(int fd) {
+    fsync(fd);
+}
+
+void truncarDescriptor(int fd, long long largo) {
+    if (ftruncate(fd, largo) != 0) registroOps.errores++;
+}
+
+long long largoDescriptor(int fd) {
+    return lseek(fd, 0, SEEK_END);
+}
+
+void cerrarDescriptor(int fd) {
+    close(fd);
+}
+
+// Reemplaza destino por origen de forma atmica. rename() ya pisa el
+// destino; despus se sincroniza el directorio para que el cambio de nombre
+// tambin sobreviva a un corte de luz.
+bool reemplazarArchivo(const char* origen, const char* destino) {
+    if (rename(origen, destino) != 0) return false;
+    const char* barra = strrchr(destino, '/');
+    string directorio = (barra == NULL) ? string(".") : string(destino, barra == destino ? 1 : barra - destino);
+    int fd = open(directorio.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+    return true;
+}
+#else
+int abrirParaAnexar(const char* ruta) {
+    return _open(ruta, _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+bool escribirTodo(int fd, const char* datos, size_t n) {
+    return _write(fd, datos, (unsigned int)n) == (int)n;
+}
+
+void sincronizarDisco(int fd) {
+    _commit(fd);
+}
+
+void truncarDescriptor(int fd, long long largo) {
+    if (_chsize_s(fd, largo) != 0) registroOps.errores++;
+}
+
+long long largoDescriptor(int fd) {
+    return _lseeki64(fd, 0, SEEK_END);
+}
+
+void cerrarDescriptor(int fd) {
+    _close(fd);
+}
+
+// rename() no pisa un archivo existente en Windows; MoveFileEx s, sin
+// dejar un momento en que el destino no exista.
+bool reemplazarArchivo(const char* origen, const char* destino) {
+    return MoveFileExA(origen, destino, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+#endif
+
+void bucleGrupo() {
+    unique_lock<mutex> cerrojo(registroOps.cerrojo);
+    while (registroOps.activo) {
+        registroOps.aviso.wait_for(cerrojo, chrono::milliseconds(registroOps.intervaloMs));
+        if (registroOps.pendiente) {
+            // El fsync va sin el cerrojo para no frenar a quien escribe.
+            registroOps.pendiente = false;
+            cerrojo.unlock();
+            sincronizarDisco(registroOps.fd);
+            cerrojo.lock();
+            registroOps.sincronizaciones++;
+        }
+    }
+}
+
+bool abrirRegistro(const char* ruta, PoliticaSync politica, int intervaloMs) {
+    int fd = abrirParaAnexar(ruta);
+    if (fd < 0) return false;
+    registroOps.fd = fd;
+    registroOps.abierto = true;
+    registroOps.politica = politica;
+    registroOps.intervaloMs = intervaloMs > 0 ? intervaloMs : 1;
+    registroOps.operaciones = 0;
+    registroOps.sincronizaciones = 0;
+    registroOps.errores = 0;
+    registroOps.pendiente = false;
+    registroOps.sinAnotar = false;
+    if (politica == SYNC_GRUPO) {
+        registroOps.activo = true;
+        registroOps.hiloGrupo = thread(bucleGrupo);
+    }
+    return true;
+}
+
+void cerrarRegistro() {
+    if (!registroOps.abierto) return;
+    if (registroOps.hiloGrupo.joinable()) {
+        {
+            lock_guard<mutex> cerrojo(registroOps.cerrojo);
+            registroOps.activo = false;
+        }
+        registroOps.aviso.notify_one();
+        registroOps.hiloGrupo.join();
+    }
+    if (registroOps.pendiente) {
+        sincronizarDisco(registroOps.fd);
+        registroOps.sincronizaciones++;
+        registroOps.pendiente = false;
+    }
+    cerrarDescriptor(registroOps.fd);
+    registroOps.abierto = false;
+    delete[] registroOps.buffer;
+    registroOps.buffer = NULL;
+    registroOps.capacidadBuffer = 0;
+}
+
+// Anexa una operacin ya aplicada en memoria. El registro se arma completo en
+// un buffer y sale en una sola escritura. Si la escritura falla a medias se
+// recorta lo escrito: un registro roto en el medio hara que la reaplicacin
+// descarte todo lo que venga detrs.
+// RETORNO: false si la operacin no qued anotada (queda marcada en sinAnotar).
+bool anotarOperacion(TipoOperacion tipo, int id, Cadena nombre, Fecha fecha, Persona* padre, Persona* madre) {
+    if (!registroOps.abierto || registroOps.reaplicando) return true;
+
+    int largo = (int)sizeof(CabeceraOperacion) + nombre.largo;
+    if (largo > registroOps.capacidadBuffer) {
+        delete[] registroOps.buffer;
+        registroOps.capacidadBuffer = largo > 256 ? largo : 256;
+        registroOps.buffer = new char[registroOps.capacidadBuffer];
+    }
+
+    CabeceraOperacion cab;
+    cab.largo = largo;
+    cab.secuencia = registroOps.secuencia + 1;
+    cab.tipo = tipo;
+    cab.id = id;
+    cab.fecha = fecha.valor;
+    cab.padre = padre != NULL ? padre->id : -1;
+    cab.madre = madre != NULL ? madre->id : -1;
+    cab.largoNombre = nombre.largo;
+    memcpy(registroOps.buffer, &cab, sizeof(cab));
+    if (nombre.largo > 0) memcpy(registroOps.buffer + sizeof(cab), nombre.datos, nombre.largo);
+    cab.crc = calcularCRC32(registroOps.buffer + sizeof(cab.crc), largo - sizeof(cab.crc));
+    memcpy(registroOps.buffer, &cab.crc, sizeof(cab.crc));
+
+    lock_guard<mutex> cerrojo(registroOps.cerrojo);
+    long long largoPrevio = largoDescriptor(registroOps.fd);
+    if (largoPrevio < 0 || !escribirTodo(registroOps.fd, registroOps.buffer, largo)) {
+        if (largoPrevio >= 0) truncarDescriptor(registroOps.fd, largoPrevio);
+        registroOps.errores++;
+        registroOps.sinAnotar = true;
+        return false;
+    }
+    registroOps.secuencia = cab.secuencia;
+    registroOps.operaciones++;
+    if (registroOps.politica == SYNC_SIEMPRE) {
+        sincronizarDisco(registroOps.fd);
+        registroOps.sincronizaciones++;
+    } else if (registroOps.politica == SYNC_GRUPO) {
+        registroOps.pendiente = true;
+    }
+    return true;
+}
+
+const char* nombrePolitica(PoliticaSync politica) {
+    switch (politica) {
+        case SYNC_SIEMPRE: return "siempre";
+        case SYNC_GRUPO:   return "grupo";
+        default:           return "nunca";
+    }
+}
+
+// =============================================================================
+// GENERACIONES
+// Persona::generacion es el camino ms largo hasta un fundador (0 = sin
+// padres) y Persona::profundidad el camino ms largo hasta un descendiente
+// (0 = sin hijos). Como generacion(hijo) >= generacion(progenitor) + 1, un
+// ancestro a d generaciones tiene generacion <= la propia - d; el parentesco
+// usa esa cota para cortar la bsqueda. Las dos etiquetas se mantienen al
+// da en cada alta, baja o cambio de padres: se recalcula solo el nodo
+// tocado y la propagacin sigue por hijos (generacin) o por padres
+// (profundidad) mientras el valor cambie, as el costo es proporcional a la
+// parte del grafo afectada. Las cargas masivas las calculan de una vez.
+// =============================================================================
+int generacionDesdePadres(Persona* p) {
+    int g = 0;
+    if (p->padre != NULL && p->padre->generacion >= 0 && p->padre->generacion + 1 > g) g = p->padre->generacion + 1;
+    if (p->madre != NULL && p->madre->generacion >= 0 && p->madre->generacion + 1 > g) g = p->madre->generacion + 1;
+    return g;
+}
+
+int profundidadDesdeHijos(Persona* p) {
+    int d = 0;
+    int n = cantidadHijos(p->id);
+    int* hijos = hijosDe(p->id);
+    for (int k = 0; k < n; k++) {
+        Persona* h = buscarPorID(hijos[k]);
+        if (h != NULL && h->profundidad + 1 > d) d = h->profundidad + 1;
+    }
+    return d;
+}
+
+// Recalcula la generacin de p y, si cambi, la de los descendientes
+// afectados. El grafo no tiene ciclos (ver calcularGeneraciones y
+// asignarPadres), as que la propagacin termina.
+void propagarGeneracion(Persona* p) {
+    if (p == NULL) return;
+    Pila pila;
+    inicializarPila(pila);
+    apilar(pila, p);
+    while (!pilaVacia(pila)) {
+        Persona* t = desapilar(pila);
+        int g = generacionDesdePadres(t);
+        if (g == t->generacion) continue;
+        t->generacion = g;
+        int n = cantidadHijos(t->id);
+        int* hijos = hijosDe(t->id);
+        for (int k = 0; k < n; k++) {
+            Persona* h = buscarPorID(hijos[k]);
+            if (h != NULL) apilar(pila, h);
+        }
+    }
+    liberarPila(pila);
+}
+
+// Recalcula la profundidad de p y, si cambi, la de los ancestros afectados.
+void propagarProfundidad(Persona* p) {
+    if (p == NULL) return;
+    Pila pila;
+    inicializarPila(pila);
+    apilar(pila, p);
+    while (!pilaVacia(pila)) {
+        Persona* t = desapilar(pila);
+        int d = profundidadDesdeHijos(t);
+        if (d == t->profundidad) continue;
+        t->profundidad = d;
+        if (t->padre != NULL) apilar(pila, t->padre);
+        if (t->madre != NULL && t->madre != t->padre) apilar(pila, t->madre);
+    }
+    liberarPila(pila);
+}
+
+// Calcula la generacin de los nodos dados, que pueden referirse entre s en
+// cualquier orden (importacin, instantnea); el resto ya la tiene. Pila
+// explcita: -1 = pendiente, -2 = en el camino actual. Un progenitor que
+// est en el camino actual cierra un ciclo (solo posible con datos
+// importados incoherentes): ese vnculo se corta. RETORNO: vnculos cortados.
+long calcularGeneraciones(Persona** nodos, long n) {
+    for (long i = 0; i < n; i++) {
+        nodos[i]->generacion = -1;
+    }
+    long cortados = 0;
+    Pila p;
+    inicializarPila(p);
+    for (long i = 0; i < n; i++) {
+        if (nodos[i]->generacion != -1) continue;
+        apilar(p, nodos[i]);
+        while (!pilaVacia(p)) {
+            Persona* t = cima(p);
+            if (t->generacion == -1) {
+                t->generacion = -2;
+                Persona* padre = t->padre;
+                Persona* madre = t->madre;
+                if (padre != NULL && padre->generacion == -2) {
+                    if (madre != padre) quitarHijo(padre->id, t->id);
+                    t->padre = NULL;
+                    cortados++;
+                }
+                if (madre != NULL && madre->generacion == -2) {
+                    quitarHijo(madre->id, t->id);
+                    t->madre = NULL;
+                    cortados++;
+                }
+                if (t->padre != NULL && t->padre->generacion == -1) apilar(p, t->padre);
+                if (t->madre != NULL && t->madre->generacion == -1) apilar(p, t->madre);
+            } else {
+                desapilar(p);
+                if (t->generacion == -2) t->generacion = generacionDesdePadres(t);
+            }
+        }
+    }
+    liberarPila(p);
+    return cortados;
+}
+
+// Calcula la profundidad de los nodos dados (ya con generacin y con sus
+// hijos en el ndice) y la propaga a sus ancestros fuera del grupo. Los
+// hijos de un nodo nuevo son nuevos, as que recorriendo por generacin
+// descendente cada uno se calcula despus de todos sus hijos.
+void calcularProfundidades(Persona** nodos, long n) {
+    int maxGen = 0;
+    for (long i = 0; i < n; i++) {
+        if (nodos[i]->generacion > maxGen) maxGen = nodos[i]->generacion;
+    }
+    long* inicioGen = new long[maxGen + 2];
+    for (int g = 0; g <= maxGen + 1; g++) inicioGen[g] = 0;
+    for (long i = 0; i < n; i++) inicioGen[nodos[i]->generacion + 1]++;
+    for (int g = 1; g <= maxGen + 1; g++) inicioGen[g] += inicioGen[g - 1];
+    Persona** orden = new Persona*[n > 0 ? n : 1];
+    for (long i = 0; i < n; i++) orden[inicioGen[nodos[i]->generacion]++] = nodos[i];
+    delete[] inicioGen;
+
+    for (long i = n - 1; i >= 0; i--) {
+        orden[i]->profundidad = profundidadDesdeHijos(orden[i]);
+    }
+    for (long i = 0; i < n; i++) {
+        propagarProfundidad(orden[i]->padre);
+        propagarProfundidad(orden[i]->madre);
+    }
+    delete[] orden;
+}
+
+// true si q es p o uno de sus descendientes. Solo baja por hijos cuya
+// generacin es menor que la de q: los dems no pueden llegar a q.
+MarcasVisita marcasDescendencia;
+
+bool esDescendiente(Persona* q, Persona* p) {
+    if (q == NULL || p == NULL) return false;
+    if (q == p) return true;
+    if (q->generacion <= p->generacion) return false;
+    nuevaVisita(marcasDescendencia, limiteCeldas());
+    Pila pila;
+    inicializarPila(pila);
+    apilar(pila, p);
+    bool encontrado = false;
+    while (!pilaVacia(pila) && !encontrado) {
+        Persona* t = desapilar(pila);
+        int n = cantidadHijos(t->id);
+        int* hijos = hijosDe(t->id);
+        for (int k = 0; k < n; k++) {
+            Persona* h = buscarPorID(hijos[k]);
+            if (h == q) {
+                encontrado = true;
+                break;
+            }
+            if (h != NULL && h->generacion < q->generacion && marcarVisitado(marcasDescendencia, h->celda)) {
+                apilar(pila, h);
+            }
+        }
+    }
+    liberarPila(pila);
+    return encontrado;
+}
+
+// =============================================================================
+// HISTORIAL DE VERSIONES (NDICE PERSISTENTE)
+// Con el historial activo, cada alta, baja o cambio de padres deja una
+// versin consultable de toda la base. Las versiones comparten estructura:
+// un AVL persistente por ID en el que insertar/eliminar copian solo los
+// O(log n) nodos del camino (y los hermanos que una rotacin modifica) y
+// devuelven una raz nueva; el resto de los nodos es comn con la versin
+// anterior. Cada nodo cuenta cuntos enlaces (nodos o races de versin)
+// lo apuntan; un nodo con una sola referencia es privado y se puede
+// modificar en el lugar, uno compartido se copia antes (copia en
+// escritura). Al descartar una versin se sueltan sus referencias y se
+// liberan los nodos que ya nadie alcanza. Los nodos guardan los datos por
+// valor y los padres por ID, as no dependen de que la persona siga viva.
+// =============================================================================
+struct NodoVersion {
+    int id;
+    Cadena nombre;
+    Fecha fecha;
+    int padre;              // ID, -1 = sin dato
+    int madre;
+    NodoVersion* izq;
+    NodoVersion* der;
+    int altura;
+    int refs;               // Enlaces que lo apuntan
+};
+
+struct Version {
+    long numero;
+    NodoVersion* raiz;
+    long personas;
+    long nodosNuevos;       // Nodos creados por esta versin
+};
+
+struct HistorialVersiones {
+    bool activo;
+    int limite;             // Versiones que se conservan (las ms viejas se sueltan)
+    Version* versiones;     // Circular, de la ms vieja a la ms nueva
+    int primera;
+    int cantidad;
+    NodoVersion* actual;    // Refleja la base; se fija como versin en cerrarVersion
+    long personas;
+    long ultimoNumero;
+    long nodosVivos;
+    long nodosCreados;      // Total histrico (para nodosNuevos)
+    long creadosAlCerrar;
+};
+
+HistorialVersiones historial = {false, 0, NULL, 0, 0, NULL, 0, 0, 0, 0, 0};
+
+int alturaV(NodoVersion* n) {
+    return n != NULL ? n->altura : 0;
+}
+
+void actualizarAlturaV(NodoVersion* n) {
+    int a = alturaV(n->izq), b = alturaV(n->der);
+    n->altura = 1 + (a > b ? a : b);
+}
+
+void retenerNodo(NodoVersion* n) {
+    if (n != NULL) n->refs++;
+}
+
+// Suelta una referencia; si era la ltima libera el nodo y sigue por sus hijos.
+void soltarNodo(NodoVersion* n) {
+    if (n == NULL || --n->refs > 0) return;
+    soltarNodo(n->izq);
+    soltarNodo(n->der);
+    delete n;
+    historial.nodosVivos--;
+}
+
+NodoVersion* nuevoNodoVersion(Persona* p) {
+    NodoVersion* n = new NodoVersion;
+    n->id = p->id;
+    n->nombre = p->nombre;
+    n->fecha = p->fecha_nac;
+    n->padre = p->padre != NULL ? p->padre->id : -1;
+    n->madre = p->madre != NULL ? p->madre->id : -1;
+    n->izq = NULL;
+    n->der = NULL;
+    n->altura = 1;
+    n->refs = 1;
+    historial.nodosVivos++;
+    historial.nodosCreados++;
+    return n;
+}
+
+// Copia privada de n (una referencia, la de quien la recibe).
+NodoVersion* copiarNodo(NodoVersion* n) {
+    NodoVersion* c = new NodoVersion(*n);
+    c->refs = 1;
+    retenerNodo(c->izq);
+    retenerNodo(c->der);
+    historial.nodosVivos++;
+    historial.nodosCreados++;
+    return c;
+}
+
+// Deja en *enlace un nodo privado (lo copia si est compartido).
+NodoVersion* privatizar(NodoVersion** enlace) {
+    NodoVersion* n = *enlace;
+    if (n != NULL && n->refs > 1) {
+        *enlace = copiarNodo(n);
+        n->refs--;
+    }
+    return *enlace;
+}
+
+// Las rotaciones solo reenlazan: cada nodo sigue con un nico enlace entrante
+// entre los tocados, as que las referencias no cambian.
+void rotarDerechaV(NodoVersion** enlace) {
+    NodoVersion* y = *enlace;
+    NodoVersion* x = privatizar(&y->izq);
+    y->izq = x->der;
+    x->der = y;
+    actualizarAlturaV(y);
+    actualizarAlturaV(x);
+    *enlace = x;
+}
+
+void rotarIzquierdaV(NodoVersion** enlace) {
+    NodoVersion* x = *enlace;
+    NodoVersion* y = privatizar(&x->der);
+    x->der = y->izq;
+    y->izq = x;
+    actualizarAlturaV(x);
+    actualizarAlturaV(y);
+    *enlace = y;
+}
+
+// *enlace es privado.
+void balancearV(NodoVersion** enlace) {
+    NodoVersion* n = *enlace;
+    actualizarAlturaV(n);
+    int balance = alturaV(n->izq) - alturaV(n->der);
+    if (balance > 1) {
+        if (alturaV(n->izq->izq) < alturaV(n->izq->der)) {
+            privatizar(&n->izq);
+            rotarIzquierdaV(&n->izq);
+        }
+        rotarDerechaV(enlace);
+    } else if (balance < -1) {
+        if (alturaV(n->der->der) < alturaV(n->der->izq)) {
+            privatizar(&n->der);
+            rotarDerechaV(&n->der);
+        }
+        rotarIzquierdaV(enlace);
+    }
+}
+
+// Inserta p, o reemplaza sus datos si el ID ya est. n es una referencia
+// prestada; devuelve una raz nueva con una referencia para quien llama.
+NodoVersion* fijarPersistente(NodoVersion* n, Persona* p) {
+    if (n == NULL) return nuevoNodoVersion(p);
+    if (p->id == n->id) {
+        NodoVersion* datos = nuevoNodoVersion(p);
+        datos->izq = n->izq;
+        datos->der = n->der;
+        datos->altura = n->altura;
+        retenerNodo(datos->izq);
+        retenerNodo(datos->der);
+        return datos;
+    }
+    NodoVersion* c = copiarNodo(n);
+    NodoVersion** lado = p->id < c->id ? &c->izq : &c->der;
+    NodoVersion* viejo = *lado;
+    *lado = fijarPersistente(viejo, p);
+    soltarNodo(viejo);
+    balancearV(&c);
+    return c;
+}
+
+// Quita el mnimo de n (prestado); en *minimo queda ese nodo (prestado).
+NodoVersion* quitarMinimoPersistente(NodoVersion* n, NodoVersion* &minimo) {
+    if (n->izq == NULL) {
+        minimo = n;
+        retenerNodo(n->der);
+        return n->der;
+    }
+    NodoVersion* c = copiarNodo(n);
+    NodoVersion* viejo = c->izq;
+    c->izq = quitarMinimoPersistente(viejo, minimo);
+    soltarNodo(viejo);
+    balancearV(&c);
+    return c;
+}
+
+NodoVersion* quitarPersistente(NodoVersion* n, int id) {
+    if (n == NULL) return NULL;
+    if (id == n->id) {
+        if (n->izq == NULL || n->der == NULL) {
+            NodoVersion* hijo = n->izq != NULL ? n->izq : n->der;
+            retenerNodo(hijo);
+            return hijo;
+        }
+        // Dos hijos: una copia del sucesor ocupa su lugar.
+        NodoVersion* minimo = NULL;
+        NodoVersion* der = quitarMinimoPersistente(n->der, minimo);
+        NodoVersion* c = new NodoVersion(*minimo);
+        c->izq = n->izq;
+        c->der = der;
+        c->refs = 1;
+        retenerNodo(c->izq);
+        historial.nodosVivos++;
+        historial.nodosCreados++;
+        balancearV(&c);
+        return c;
+    }
+    NodoVersion* c = copiarNodo(n);
+    NodoVersion** lado = id < c->id ? &c->izq : &c->der;
+    NodoVersion* viejo = *lado;
+    *lado = quitarPersistente(viejo, id);
+    soltarNodo(viejo);
+    balancearV(&c);
+    return c;
+}
+
+const NodoVersion* buscarEnVersion(const NodoVersion* n, int id) {
+    while (n != NULL && n->id != id) n = id < n->id ? n->izq : n->der;
+    return n;
+}
+
+NodoVersion* construirVersionBalanceada(Persona** nodos, long inicio, long fin) {
+    if (inicio > fin) return NULL;
+    long medio = inicio + (fin - inicio) / 2;
+    NodoVersion* raiz = nuevoNodoVersion(nodos[medio]);
+    raiz->izq = construirVersionBalanceada(nodos, inicio, medio - 1);
+    raiz->der = construirVersionBalanceada(nodos, medio + 1, fin);
+    actualizarAlturaV(raiz);
+    return raiz;
+}
+
+// Versin n-sima ms vieja de las conservadas.
+Version &versionEn(int k) {
+    return historial.versiones[(historial.primera + k) % historial.limite];
+}
+
+// Fija el estado actual como versin nueva. RETORNO: su nmero.
+long cerrarVersion() {
+    HistorialVersiones &h = historial;
+    if (h.cantidad == h.limite) {
+        soltarNodo(versionEn(0).raiz);
+        h.primera = (h.primera + 1) % h.limite;
+        h.cantidad--;
+    }
+    Version &v = h.versiones[(h.primera + h.cantidad) % h.limite];
+    h.cantidad++;
+    v.numero = ++h.ultimoNumero;
+    v.raiz = h.actual;
+    retenerNodo(v.raiz);
+    v.personas = h.personas;
+    v.nodosNuevos = h.nodosCreados - h.creadosAlCerrar;
+    h.creadosAlCerrar = h.nodosCreados;
+    return v.numero;
+}
+
+// Rehace la versin actual desde la tabla (activacin, importacin).
+void reconstruirVersionActual() {
+    long n = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        if (tablaGlobal.personas[i] != NULL) n++;
+    }
+    Persona** vivas = new Persona*[n > 0 ? n : 1];
+    n = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        if (tablaGlobal.personas[i] != NULL) vivas[n++] = tablaGlobal.personas[i];
+    }
+    soltarNodo(historial.actual);
+    historial.actual = construirVersionBalanceada(vivas, 0, n - 1);
+    historial.personas = n;
+    delete[] vivas;
+}
+
+void activarHistorial(int limite) {
+    if (historial.activo) return;
+    if (limite < 1) limite = 1;
+    historial.activo = true;
+    historial.limite = limite;
+    historial.versiones = new Version[limite];
+    historial.primera = 0;
+    historial.cantidad = 0;
+    historial.creadosAlCerrar = historial.nodosCreados;
+    reconstruirVersionActual();
+    cerrarVersion();
+}
+
+void desactivarHistorial() {
+    if (!historial.activo) return;
+    for (int k = 0; k < historial.cantidad; k++) soltarNodo(versionEn(k).raiz);
+    soltarNodo(historial.actual);
+    delete[] historial.versiones;
+    historial.versiones = NULL;
+    historial.actual = NULL;
+    historial.cantidad = 0;
+    historial.personas = 0;
+    historial.activo = false;
+}
+
+// Ganchos de OPERACIONES SOBRE LA BASE.
+void versionarPersona(Persona* p) {
+    if (!historial.activo) return;
+    if (buscarEnVersion(historial.actual, p->id) == NULL) historial.personas++;
+    NodoVersion* viejo = historial.actual;
+    historial.actual = fijarPersistente(viejo, p);
+    soltarNodo(viejo);
+}
+
+void versionarBaja(int id) {
+    if (!historial.activo || buscarEnVersion(historial.actual, id) == NULL) return;
+    NodoVersion* viejo = historial.actual;
+    historial.actual = quitarPersistente(viejo, id);
+    soltarNodo(viejo);
+    historial.personas--;
+}
+
+// Versin conservada con ese nmero, o NULL.
+Version* buscarVersion(long numero) {
+    for (int k = 0; k < historial.cantidad; k++) {
+        if (versionEn(k).numero == numero) return &versionEn(k);
+    }
+    return NULL;
+}
+
+// Diferencias entre dos versiones en orden de ID. Cada lado es una
+// secuencia de subrboles o nodos sueltos; dos subrboles idnticos (el
+// mismo nodo) se saltean enteros, as el costo crece con los cambios y no
+// con el tamao de la base. Cambio: antes y despues != NULL.
+typedef void (*VisitaDiferencia)(const NodoVersion* antes, const NodoVersion* despues);
+
+struct TramoVersion {
+    NodoVersion* nodo;
+    bool suelto;            // true: solo el nodo; false: todo su subrbol
+};
+
+struct SecuenciaVersion {
+    TramoVersion* tramos;   // Pila: la cima es el prximo en orden
+    int cantidad;
+    int capacidad;
+};
+
+void empujarTramo(SecuenciaVersion &s, NodoVersion* n, bool suelto) {
+    if (n == NULL) return;
+    if (s.cantidad == s.capacidad) {
+        int nuevaCap = s.capacidad == 0 ? 64 : s.capacidad * 2;
+        TramoVersion* nuevos = new TramoVersion[nuevaCap];
+        for (int i = 0; i < s.cantidad; i++) nuevos[i] = s.tramos[i];
+        delete[] s.tramos;
+        s.tramos = nuevos;
+        s.capacidad = nuevaCap;
+    }
+    s.tramos[s.cantidad].nodo = n;
+    s.tramos[s.cantidad].suelto = suelto;
+    s.cantidad++;
+}
+
+// Reemplaza el subrbol de la cima por izquierdo, nodo y derecho.
+void abrirTramo(SecuenciaVersion &s) {
+    NodoVersion* n = s.tramos[--s.cantidad].nodo;
+    empujarTramo(s, n->der, false);
+    empujarTramo(s, n, true);
+    empujarTramo(s, n->izq, false);
+}
+
+bool mismosDatos(const NodoVersion* a, const NodoVersion* b) {
+    return a->fecha == b->fecha && a->padre == b->padre && a->madre == b->madre
+        && a->nombre.largo == b->nombre.largo && memcmp(a->nombre.datos, b->nombre.datos, a->nombre.largo) == 0;
+}
+
+long compararVersiones(NodoVersion* antes, NodoVersion* despues, VisitaDiferencia visita) {
+    SecuenciaVersion a = {NULL, 0, 0}, b = {NULL, 0, 0};
+    empujarTramo(a, antes, false);
+    empujarTramo(b, despues, false);
+    long diferencias = 0;
+    while (a.cantidad > 0 || b.cantidad > 0) {
+        TramoVersion* ta = a.cantidad > 0 ? &a.tramos[a.cantidad - 1] : NULL;
+        TramoVersion* tb = b.cantidad > 0 ? &b.tramos[b.cantidad - 1] : NULL;
+        if (ta != NULL && tb != NULL && ta->nodo == tb->nodo && !ta->suelto && !tb->suelto) {
+            a.cantidad--;
+            b.cantidad--;
+        } else if (ta != NULL && !ta->suelto && (tb == NULL || tb->suelto || alturaV(ta->nodo) >= alturaV(tb->nodo))) {
+            abrirTramo(a);
+        } else if (tb != NULL && !tb->suelto) {
+            abrirTramo(b);
+        } else if (tb == NULL || (ta != NULL && ta->nodo->id < tb->nodo->id)) {
+            visita(ta->nodo, NULL);
+            diferencias++;
+            a.cantidad--;
+        } else if (ta == NULL || tb->nodo->id < ta->nodo->id) {
+            visita(NULL, tb->nodo);
+            diferencias++;
+            b.cantidad--;
+        } else {
+            if (ta->nodo != tb->nodo && !mismosDatos(ta->nodo, tb->nodo)) {
+                visita(ta->nodo, tb->nodo);
+                diferencias++;
+            }
+            a.cantidad--;
+            b.cantidad--;
+        }
+    }
+    delete[] a.tramos;
+    delete[] b.tramos;
+    return diferencias;
+}
+
+// =============================================================================
+// OPERACIONES SOBRE LA BASE DE PERSONAS
+// Punto nico de alta y baja: mantiene sincronizados el rbol, el almacn y
+// los ndices secundarios. cambiosBase cuenta las modificaciones, para saber
+// si un resultado calculado sobre toda la base sigue vigente.
+// =============================================================================
+long cambiosBase = 0;
+
+Persona* agregarPersona(Persona* &arbol, int id, Cadena nombre, Fecha fecha, Persona* padre, Persona* madre) {
+    if (id < 0 || id > ID_MAXIMO || buscarPorID(id) != NULL) return NULL;
+
+    Persona* nueva = insertar(arbol, id, nombre, fecha, padre, madre);
+    if (nueva != NULL) {
+        cambiosBase++;
+        nueva->generacion = generacionDesdePadres(nueva);
+        registrarEnAlmacen(nueva);
+        agregarATabla(nueva);
+        indexarNombre(nueva);
+        agregarAFechas(nueva);
+        if (padre != NULL) agregarHijo(padre->id, id);
+        if (madre != NULL && madre != padre) agregarHijo(madre->id, id);
+        propagarProfundidad(padre);
+        propagarProfundidad(madre);
+        if (historial.activo) {
+            versionarPersona(nueva);
+            cerrarVersion();
+        }
+        anotarOperacion(OPERACION_ALTA, id, nombre, fecha, padre, madre);
+    }
+    return nueva;
+}
+
+bool quitarPersona(Persona* &arbol, int id) {
+    Persona* p = buscarPorID(id);
+    if (p == NULL) return false;
+    cambiosBase++;
+
+    if (p->padre != NULL) quitarHijo(p->padre->id, id);
+    if (p->madre != NULL && p->madre != p->padre) quitarHijo(p->madre->id, id);
+    propagarProfundidad(p->padre);
+    propagarProfundidad(p->madre);
+    // Los hijos dejan de apuntar al nodo que se va a liberar.
+    int n = cantidadHijos(id);
+    int* hijos = hijosDe(id);
+    for (int k = 0; k < n; k++) {
+        Persona* h = buscarPorID(hijos[k]);
+        if (h == NULL) continue;
+        if (h->padre == p) h->padre = NULL;
+        if (h->madre == p) h->madre = NULL;
+        propagarGeneracion(h);
+        versionarPersona(h);
+    }
+    soltarHijos(id);
+    if (historial.activo) {
+        versionarBaja(id);
+        cerrarVersion();
+    }
+
+    desindexarNombre(p);
+    quitarDeFechas(p);
+    borrarDeAlmacen(id);
+    quitarDeTabla(id);
+    arbol = eliminar(arbol, id);
+    anotarOperacion(OPERACION_BAJA, id, Cadena(), FECHA_DESCONOCIDA, NULL, NULL);
+    return true;
+}
+
+// Cambia los padres de p (NULL = sin dato). Falla si alguno es p o un
+// descendiente suyo, porque formara un ciclo.
+bool asignarPadres(Persona* p, Persona* padre, Persona* madre) {
+    if (p == NULL || esDescendiente(padre, p) || esDescendiente(madre, p)) return false;
+    cambiosBase++;
+
+    Persona* padreAnterior = p->padre;
+    Persona* madreAnterior = p->madre;
+    if (padreAnterior != NULL) quitarHijo(padreAnterior->id, p->id);
+    if (madreAnterior != NULL && madreAnterior != padreAnterior) quitarHijo(madreAnterior->id, p->id);
+    p->padre = padre;
+    p->madre = madre;
+    if (padre != NULL) agregarHijo(padre->id, p->id);
+    if (madre != NULL && madre != padre) agregarHijo(madre->id, p->id);
+
+    propagarGeneracion(p);
+    propagarProfundidad(padreAnterior);
+    propagarProfundidad(madreAnterior);
+    propagarProfundidad(padre);
+    propagarProfundidad(madre);
+    if (historial.activo) {
+        versionarPersona(p);
+        cerrarVersion();
+    }
+    anotarOperacion(OPERACION_PADRES, p->id, Cadena(), FECHA_DESCONOCIDA, padre, madre);
+    return true;
+}
+
+// =============================================================================
+// IMPORTACIN MASIVA (CSV / GEDCOM)
+// Lee el archivo en bloques de tamao fijo sin cargarlo entero. Primera
+// pasada: registros compactos (los nombres van a un arreglo de texto comn).
+// Segunda pasada: crea los nodos en la arena, los registra por ID, resuelve
+// padre/madre (se admiten referencias hacia adelante) y construye el ndice
+// AVL balanceado de abajo hacia arriba en O(n), como construirArbolBalanceado
+// en "Arbol Genealogico.cpp", fusionando con las personas ya cargadas.
+// CSV: id,nombre,fecha,id_padre,id_madre (tambin con ';'; 0 o vaco = sin dato).
+// Las fechas no vlidas o incompletas se importan como desconocidas y, a
+// diferencia del alta por men, no se limita el rango de aos.
+// =============================================================================
+const int TAM_BUFFER_LECTURA = 1 << 16;
+
+struct LectorBuffer {
+    FILE* archivo;
+    char datos[TAM_BUFFER_LECTURA + 1];
+    int inicio;
+    int fin;
+    bool finArchivo;
+    bool cortada;           // La ltima lnea devuelta no entraba en el buffer
+    bool saltando;          // Se est descartando el resto de esa lnea
+    long bytesLeidos;
+};
+
+// ruta "-" lee de la entrada estndar.
+LectorBuffer* abrirLector(const char* ruta) {
+    FILE* archivo = (strcmp(ruta, "-") == 0) ? stdin : fopen(ruta, "rb");
+    if (archivo == NULL) return NULL;
+    LectorBuffer* l = new LectorBuffer;
+    l->archivo = archivo;
+    l->inicio = 0;
+    l->fin = 0;
+    l->finArchivo = false;
+    l->cortada = false;
+    l->saltando = false;
+    l->bytesLeidos = 0;
+    return l;
+}
+
+void cerrarLector(LectorBuffer* l) {
+    if (l->archivo != stdin) fclose(l->archivo);
+    delete l;
+}
+
+// Devuelve la siguiente lnea, sin fin de lnea y terminada en '\0', apuntando
+// dentro del buffer (vlida hasta la prxima llamada). De una lnea ms larga
+// que el buffer se devuelve solo el principio con l->cortada en true, y el
+// resto se descarta para que no aparezca como lneas sueltas.
+bool siguienteLinea(LectorBuffer* l, char* &linea, int &largo) {
+    l->cortada = false;
+    while (true) {
+        char* salto = (char*)memchr(l->datos + l->inicio, '\n', l->fin - l->inicio);
+        if (l->saltando) {
+            if (salto != NULL) {
+                l->inicio = (int)(salto - l->datos) + 1;
+                l->saltando = false;
+                continue;
+            }
+            l->inicio = l->fin;
+        } else if (salto != NULL || (l->finArchivo && l->inicio < l->fin) || l->fin - l->inicio == TAM_BUFFER_LECTURA) {
+            linea = l->datos + l->inicio;
+            largo = (salto != NULL) ? (int)(salto - linea) : l->fin - l->inicio;
+            l->inicio += (salto != NULL) ? largo + 1 : largo;
+            if (salto == NULL && !l->finArchivo) {
+                l->cortada = true;
+                l->saltando = true;
+            }
+            if (largo > 0 && linea[largo - 1] == '\r') largo--;
+            linea[largo] = '\0';
+            return true;
+        }
+        if (l->finArchivo) return false;
+
+        int resto = l->fin - l->inicio;
+        memmove(l->datos, l->datos + l->inicio, resto);
+        l->inicio = 0;
+        l->fin = resto;
+        size_t n = fread(l->datos + l->fin, 1, TAM_BUFFER_LECTURA - l->fin, l->archivo);
+        l->fin += (int)n;
+        l->bytesLeidos += (long)n;
+        if (n == 0) l->finArchivo = true;
+    }
+}
+
+struct RegistroImportado {
+    int id;
+    int idPadre;
+    int idMadre;
+    Fecha fecha;
+    long nombreInicio;      // Posicin en LoteImportacion::textos
+    int nombreLargo;
+};
+
+struct LoteImportacion {
+    RegistroImportado* registros;
+    long cantidad;
+    long capacidad;
+    char* textos;
+    long usadosTexto;
+    long capacidadTexto;
+};
+
+struct ResultadoImportacion {
+    long leidos;
+    long importados;
+    long rechazados;        // ID fuera de 0..ID_MAXIMO, repetido o lnea ms larga que el buffer
+    long sinResolver;       // Padre/madre que no existe
+    long ciclosCortados;    // Vnculos ignorados porque cerraban un ciclo
+    double segundos;
+    long picoMemoriaKB;
+};
+
+void inicializarLote(LoteImportacion &lote) {
+    lote.registros = NULL;
+    lote.cantidad = 0;
+    lote.capacidad = 0;
+    lote.textos = NULL;
+    lote.usadosTexto = 0;
+    lote.capacidadTexto = 0;
+}
+
+void liberarLote(LoteImportacion &lote) {
+    delete[] lote.registros;
+    delete[] lote.textos;
+    inicializarLote(lote);
+}
+
+RegistroImportado* nuevoRegistro(LoteImportacion &lote) {
+    if (lote.cantidad == lote.capacidad) {
+        long nuevaCap = (lote.capacidad == 0) ? 4096 : lote.capacidad * 2;
+        RegistroImportado* nuevos = new RegistroImportado[nuevaCap];
+        if (lote.cantidad > 0) memcpy(nuevos, lote.registros, sizeof(RegistroImportado) * lote.cantidad);
+        delete[] lote.registros;
+        lote.registros = nuevos;
+        lote.capacidad = nuevaCap;
+    }
+    RegistroImportado* r = &lote.registros[lote.cantidad++];
+    r->id = -1;
+    r->idPadre = 0;
+    r->idMadre = 0;
+    r->fecha = FECHA_DESCONOCIDA;
+    r->nombreInicio = 0;
+    r->nombreLargo = 0;
+    return r;
+}
+
+void guardarNombre(LoteImportacion &lote, RegistroImportado* r, const char* texto, int largo) {
+    if (lote.usadosTexto + largo > lote.capacidadTexto) {
+        long nuevaCap = (lote.capacidadTexto == 0) ? 65536 : lote.capacidadTexto * 2;
+        while (nuevaCap < lote.usadosTexto + largo) nuevaCap *= 2;
+        char* nuevos = new char[nuevaCap];
+        if (lote.usadosTexto > 0) memcpy(nuevos, lote.textos, lote.usadosTexto);
+        delete[] lote.textos;
+        lote.textos = nuevos;
+        lote.capacidadTexto = nuevaCap;
+    }
+    memcpy(lote.textos + lote.usadosTexto, texto, largo);
+    r->nombreInicio = lote.usadosTexto;
+    r->nombreLargo = largo;
+    lote.usadosTexto += largo;
+}
+
+// Entero sin signo al inicio del texto; -1 si no empieza por dgito.
+int leerEntero(const char* texto) {
+    while (*texto == ' ') texto++;
+    if (*texto < '0' || *texto > '9') return -1;
+    long valor = 0;
+    while (*texto >= '0' && *texto <= '9' && valor <= 2147483647L) {
+        valor = valor * 10 + (*texto++ - '0');
+    }
+    return (valor > 2147483647L) ? -1 : (int)valor;
+}
+
+// Nmero contenido en una referencia GEDCOM como "@I123@".
+int numeroDeReferencia(const char* ref) {
+    while (*ref != '\0' && (*ref < '0' || *ref > '9')) ref++;
+    return leerEntero(ref);
+}
+
+// Divide la lnea en campos (modificndola). Quita espacios y comillas;
+// dentro de un campo entre comillas, "" es una comilla literal (RFC 4180).
+int dividirCampos(char* linea, char separador, char* campos[], int maxCampos) {
+    int n = 0;
+    char* p = linea;
+    while (n < maxCampos) {
+        while (*p == ' ') p++;
+        bool comillas = (*p == '"');
+        if (comillas) p++;
+        campos[n++] = p;
+        char* fin = p;
+        if (comillas) {
+            // Se compacta en el lugar: cada "" deja una sola comilla.
+            while (*p != '\0' && (*p != '"' || p[1] == '"')) {
+                if (*p == '"') p++;
+                *fin++ = *p++;
+            }
+            if (*p == '"') p++;
+            while (*p != '\0' && *p != separador) p++;
+        } else {
+            while (*p != '\0' && *p != separador) p++;
+            fin = p;
+            while (fin > campos[n - 1] && fin[-1] == ' ') fin--;
+        }
+        bool ultimo = (*p == '\0');
+        *fin = '\0';
+        if (ultimo) break;
+        p++;
+    }
+    return n;
+}
+
+void leerCSV(LectorBuffer* l, LoteImportacion &lote, ResultadoImportacion &res) {
+    char* linea;
+    int largo;
+    char separador = 0;
+    bool primera = true;
+
+    while (siguienteLinea(l, linea, largo)) {
+        if (l->cortada) {
+            primera = false;
+            res.leidos++;
+            res.rechazados++;
+            continue;
+        }
+        if (primera && largo >= 3 && (unsigned char)linea[0] == 0xEF && (unsigned char)linea[1] == 0xBB && (unsigned char)linea[2] == 0xBF) {
+            linea += 3;     // BOM UTF-8
+        }
+        if (separador == 0) {
+            separador = (strchr(linea, ';') != NULL) ? ';' : ',';
+        }
+        char* campos[5];
+        int n = dividirCampos(linea, separador, campos, 5);
+        int id = leerEntero(campos[0]);
+        if (primera) {
+            primera = false;
+            if (id < 0) continue;   // Encabezado
+        }
+        if (linea[0] == '\0') continue;
+        res.leidos++;
+        if (id < 0 || id > ID_MAXIMO || n < 2) {
+            res.rechazados++;
+            continue;
+        }
+
+        RegistroImportado* r = nuevoRegistro(lote);
+        r->id = id;
+        guardarNombre(lote, r, campos[1], (int)strlen(campos[1]));
+        if (n > 2 && !parsearFecha(campos[2], r->fecha)) r->fecha = FECHA_DESCONOCIDA;
+        if (n > 3) r->idPadre = leerEntero(campos[3]) > 0 ? leerEntero(campos[3]) : 0;
+        if (n > 4) r->idMadre = leerEntero(campos[4]) > 0 ? leerEntero(campos[4]) : 0;
+    }
+}
+
+// Fecha GEDCOM "12 JAN 1950"; las parciales o aproximadas quedan desconocidas.
+Fecha fechaGEDCOM(const char* texto) {
+    static const char* meses[12] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN",
+                                    "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    int dia = leerEntero(texto);
+    if (dia < 1) return FECHA_DESCONOCIDA;
+    while (*texto >= '0' && *texto <= '9') texto++;
+    while (*texto == ' ') texto++;
+    int mes = 0;
+    for (int i = 0; i < 12; i++) {
+        if (strncmp(texto, meses[i], 3) == 0) mes = i + 1;
+    }
+    if (mes == 0 || texto[3] != ' ') return FECHA_DESCONOCIDA;
+    int anio = leerEntero(texto + 4);
+    if (anio < 1 || dia > diasDelMes(mes, anio)) return FECHA_DESCONOCIDA;
+    return empaquetarFecha(dia, mes, anio);
+}
+
+int compararRegistros(const void* a, const void* b) {
+    int x = ((const RegistroImportado*)a)->id;
+    int y = ((const RegistroImportado*)b)->id;
+    return (x > y) - (x < y);
+}
+
+long buscarRegistro(LoteImportacion &lote, int id) {
+    long inicio = 0, fin = lote.cantidad - 1;
+    while (inicio <= fin) {
+        long medio = (inicio + fin) / 2;
+        if (lote.registros[medio].id == id) return medio;
+        if (lote.registros[medio].id < id) inicio = medio + 1;
+        else fin = medio - 1;
+    }
+    return -1;
+}
+
+// GEDCOM: INDI con NAME y BIRT/DATE; los padres salen de los FAM (HUSB,
+// WIFE, CHIL), que se resuelven cuando ya se leyeron todos los INDI.
+void leerGEDCOM(LectorBuffer* l, LoteImportacion &lote, ResultadoImportacion &res) {
+    ListaEnteros famPadre, famMadre, hijoID, hijoFam;
+    inicializarEnteros(famPadre);
+    inicializarEnteros(famMadre);
+    inicializarEnteros(hijoID);
+    inicializarEnteros(hijoFam);
+
+    char* linea;
+    int largo;
+    RegistroImportado* actual = NULL;
+    bool enFamilia = false;
+    bool enNacimiento = false;
+
+    while (siguienteLinea(l, linea, largo)) {
+        if (l->cortada) {
+            res.rechazados++;
+            continue;
+        }
+        char* p = linea;
+        while (*p == ' ' || *p == '\t' || (unsigned char)*p == 0xEF || (unsigned char)*p == 0xBB || (unsigned char)*p == 0xBF) p++;
+        int nivel = leerEntero(p);
+        if (nivel < 0) continue;
+        while (*p >= '0' && *p <= '9') p++;
+        while (*p == ' ') p++;
+
+        char* ref = NULL;
+        if (*p == '@') {
+            ref = p;
+            p = strchr(p + 1, '@');
+            if (p == NULL) continue;
+            p++;
+            while (*p == ' ') p++;
+        }
+        char* etiqueta = p;
+        while (*p != '\0' && *p != ' ') p++;
+        char* valor = p;
+        if (*p == ' ') {
+            *p = '\0';
+            valor = p + 1;
+        }
+
+        if (nivel == 0) {
+            actual = NULL;
+            enFamilia = false;
+            if (strcmp(etiqueta, "INDI") == 0) {
+                res.leidos++;
+                int id = (ref != NULL) ? numeroDeReferencia(ref) : -1;
+                if (id < 0 || id > ID_MAXIMO) {
+                    res.rechazados++;
+                    continue;
+                }
+                actual = nuevoRegistro(lote);
+                actual->id = id;
+            } else if (strcmp(etiqueta, "FAM") == 0) {
+                enFamilia = true;
+                agregarEntero(famPadre, 0);
+                agregarEntero(famMadre, 0);
+            }
+        } else if (actual != NULL) {
+            if (nivel == 1) {
+                enNacimiento = (strcmp(etiqueta, "BIRT") == 0);
+                if (strcmp(etiqueta, "NAME") == 0 && actual->nombreLargo == 0) {
+                    // "Juan /Garca/" -> "Juan Garca"
+                    char* d = valor;
+                    for (char* s = valor; *s != '\0'; s++) {
+                        if (*s != '/') *d++ = *s;
+                    }
+                    while (d > valor && d[-1] == ' ') d--;
+                    guardarNombre(lote, actual, valor, (int)(d - valor));
+                }
+            } else if (nivel == 2 && enNacimiento && strcmp(etiqueta, "DATE") == 0) {
+                actual->fecha = fechaGEDCOM(valor);
+            }
+        } else if (enFamilia && nivel == 1) {
+            int id = numeroDeReferencia(valor);
+            if (id <= 0) continue;
+            if (strcmp(etiqueta, "HUSB") == 0) famPadre.datos[famPadre.cantidad - 1] = id;
+            if (strcmp(etiqueta, "WIFE") == 0) famMadre.datos[famMadre.cantidad - 1] = id;
+            if (strcmp(etiqueta, "CHIL") == 0) {
+                agregarEntero(hijoID, id);
+                agregarEntero(hijoFam, famPadre.cantidad - 1);
+            }
+        }
+    }
+
+    qsort(lote.registros, lote.cantidad, sizeof(RegistroImportado), compararRegistros);
+    for (int i = 0; i < hijoID.cantidad; i++) {
+        long pos = buscarRegistro(lote, hijoID.datos[i]);
+        if (pos < 0) continue;
+        lote.registros[pos].idPadre = famPadre.datos[hijoFam.datos[i]];
+        lote.registros[pos].idMadre = famMadre.datos[hijoFam.datos[i]];
+    }
+
+    liberarEnteros(famPadre);
+    liberarEnteros(famMadre);
+    liberarEnteros(hijoID);
+    liberarEnteros(hijoFam);
+}
+
+// Construye un AVL perfectamente balanceado con nodos ya ordenados por ID.
+Persona* construirArbolBalanceado(Persona** nodos, long inicio, long fin) {
+    if (inicio > fin) return NULL;
+
+    long medio = inicio + (fin - inicio) / 2;
+    Persona* raiz = nodos[medio];
+
+    raiz->izq = construirArbolBalanceado(nodos, inicio, medio - 1);
+    raiz->der = construirArbolBalanceado(nodos, medio + 1, fin);
+    actualizarAltura(raiz);
+
+    return raiz;
+}
+
+long picoMemoriaKB() {
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);
+#ifdef __APPLE__
+    return uso.ru_maxrss / 1024;        // En macOS viene en bytes
+#else
+    return uso.ru_maxrss;
+#endif
+#endif
+}
+
+// Segunda pasada: nodos, parentescos, ndices y rbol balanceado.
+void cargarLote(Persona* &arbol, LoteImportacion &lote, ResultadoImportacion &res) {
+    bool ordenado = true;
+    for (long i = 1; i < lote.cantidad && ordenado; i++) {
+        ordenado = lote.registros[i - 1].id <= lote.registros[i].id;
+    }
+    if (!ordenado) {
+        qsort(lote.registros, lote.cantidad, sizeof(RegistroImportado), compararRegistros);
+    }
+
+    Persona** nuevos = new Persona*[lote.cantidad > 0 ? lote.cantidad : 1];
+    RegistroImportado** origen = new RegistroImportado*[lote.cantidad > 0 ? lote.cantidad : 1];
+    long cantidadNuevos = 0;
+
+    for (long i = 0; i < lote.cantidad; i++) {
+        RegistroImportado &r = lote.registros[i];
+        if ((i > 0 && lote.registros[i - 1].id == r.id) || buscarPorID(r.id) != NULL) {
+            res.rechazados++;
+            continue;
+        }
+        Persona* p = crearPersona(r.id, guardarCadena(lote.textos + r.nombreInicio, r.nombreLargo), r.fecha);
+        registrarEnAlmacen(p);
+        indexarNombre(p);
+        nuevos[cantidadNuevos] = p;
+        origen[cantidadNuevos] = &r;
+        cantidadNuevos++;
+    }
+
+    for (long i = 0; i < cantidadNuevos; i++) {
+        Persona* p = nuevos[i];
+        RegistroImportado* r = origen[i];
+        if (r->idPadre > 0 && r->idPadre != p->id) {
+            p->padre = buscarPorID(r->idPadre);
+            if (p->padre == NULL) res.sinResolver++;
+        }
+        if (r->idMadre > 0 && r->idMadre != p->id) {
+            p->madre = buscarPorID(r->idMadre);
+            if (p->madre == NULL) res.sinResolver++;
+        }
+        if (p->padre != NULL) agregarHijo(p->padre->id, p->id);
+        if (p->madre != NULL && p->madre != p->padre) agregarHijo(p->madre->id, p->id);
+    }
+    res.ciclosCortados = calcularGeneraciones(nuevos, cantidadNuevos);
+    calcularProfundidades(nuevos, cantidadNuevos);
+    cambiosBase++;
+
+    // Fusin con las personas existentes (la tabla ya est ordenada por ID).
+    long total = cantidadNuevos;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        if (tablaGlobal.personas[i] != NULL) total++;
+    }
+    Persona** todos = new Persona*[total > 0 ? total : 1];
+    long a = 0, b = 0, k = 0;
+    while (a < tablaGlobal.cantidad || b < cantidadNuevos) {
+        if (a < tablaGlobal.cantidad && tablaGlobal.personas[a] == NULL) {
+            a++;
+        } else if (b == cantidadNuevos || (a < tablaGlobal.cantidad && tablaGlobal.ids[a] < nuevos[b]->id)) {
+            todos[k++] = tablaGlobal.personas[a++];
+        } else {
+            todos[k++] = nuevos[b++];
+        }
+    }
+
+    arbol = construirArbolBalanceado(todos, 0, total - 1);
+    estadisticasAVL.nodos = total;
+    if (total > 0 && todos[total - 1]->id >= proximoID) {
+        proximoID = todos[total - 1]->id + 1;
+    }
+
+    inicializarTabla();
+    for (long i = 0; i < total; i++) {
+        agregarATabla(todos[i]);
+    }
+    construirIndiceFechas(todos, total);
+
+    // Una importacin es una sola versin: pocas altas se insertan con
+    // copia de caminos; muchas, rehaciendo el ndice persistente.
+    if (historial.activo && cantidadNuevos > 0) {
+        if (cantidadNuevos * 32 < total) {
+            for (long i = 0; i < cantidadNuevos; i++) versionarPersona(nuevos[i]);
+        } else {
+            reconstruirVersionActual();
+        }
+        cerrarVersion();
+    }
+
+    res.importados = cantidadNuevos;
+    delete[] todos;
+    delete[] nuevos;
+    delete[] origen;
+}
+
+bool esArchivoGEDCOM(const char* ruta) {
+    const char* punto = strrchr(ruta, '.');
+    if (punto == NULL) return false;
+    return strcmp(punto, ".ged") == 0 || strcmp(punto, ".GED") == 0;
+}
+
+// RETORNO: false si el archivo no se pudo abrir.
+bool importarArchivo(Persona* &arbol, const char* ruta, ResultadoImportacion &res) {
+    ResultadoImportacion vacio = {0, 0, 0, 0, 0, 0.0, 0};
+    res = vacio;
+
+    LectorBuffer* l = abrirLector(ruta);
+    if (l == NULL) return false;
+
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    LoteImportacion lote;
+    inicializarLote(lote);
+
+    if (esArchivoGEDCOM(ruta)) {
+        leerGEDCOM(l, lote, res);
+    } else {
+        leerCSV(l, lote, res);
+    }
+    cerrarLector(l);
+
+    cargarLote(arbol, lote, res);
+    liberarLote(lote);
+
+    res.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    res.picoMemoriaKB = picoMemoriaKB();
+    return true;
+}
+
+void mostrarResultadoImportacion(ResultadoImportacion &res) {
+    cout << "  Registros leidos    : " << res.leidos << "\n";
+    cout << "  Importados          : " << res.importados << "\n";
+    cout << "  Rechazados          : " << res.rechazados << "\n";
+    cout << "  Padres sin resolver : " << res.sinResolver << "\n";
+    if (res.ciclosCortados > 0) {
+        cout << "  Ciclos cortados     : " << res.ciclosCortados << "\n";
+    }
+    cout << "  Tiempo              : " << fixed << setprecision(3) << res.segundos << " s";
+    if (res.segundos > 0) {
+        cout << " (" << (long)(res.leidos / res.segundos) << " registros/s)";
+    }
+    cout << "\n";
+    if (res.picoMemoriaKB > 0) {
+        cout << "  Pico de memoria     : " << res.picoMemoriaKB / 1024 << " MB\n";
+    }
+}
+
+// =============================================================================
+// INSTANTNEA BINARIA
+// Formato versionado pensado para mapearse en memoria y usarse sin
+// interpretar texto:
+//   [CabeceraInstantanea][RegistroInstantanea x cantidad][texto de nombres]
+// Los registros van ordenados por ID y enlazan padre/madre por ndice de
+// registro. Los nombres de las personas cargadas apuntan directamente al
+// archivo mapeado, que sigue mapeado hasta vaciar la base. Enteros en el
+// orden de bytes de la mquina (little-endian en x86/ARM).
+// =============================================================================
+const char MAGIA_INSTANTANEA[8] = {'A', 'R', 'B', 'G', 'E', 'N', 'S', 0};
+const unsigned int VERSION_INSTANTANEA = 2;     // v2: ultimaOperacion
+const char* ARCHIVO_INSTANTANEA = "arbol.snap";
+
+struct CabeceraInstantanea {
+    char magia[8];
+    unsigned int version;
+    unsigned int tamRegistro;       // sizeof(RegistroInstantanea), para validar
+    long long cantidad;
+    long long proximoID;
+    long long bytesTexto;
+    long long ultimaOperacion;      // Secuencia del registro ya incluida (0 en v1)
+    long long reservado[2];
+};
+
+struct RegistroInstantanea {
+    int id;
+    unsigned int fecha;             // Fecha::valor
+    int padre;                      // ndice de registro, -1 si no tiene
+    int madre;
+    long long nombreInicio;         // Desplazamiento dentro del texto
+    int nombreLargo;
+    int relleno;
+};
+
+struct InstantaneaMapeada {
+    char* base;
+    size_t tamano;
+    bool mapeada;                   // false: copia leda con fread (Windows)
+};
+
+InstantaneaMapeada instantaneaActiva = {NULL, 0, false};
+double msUltimaCarga = 0;
+
+void soltarMapeo(InstantaneaMapeada &m) {
+    if (m.base == NULL) return;
+#ifndef _WIN32
+    if (m.mapeada) {
+        munmap(m.base, m.tamano);
+    } else
+#endif
+    {
+        delete[] m.base;
+    }
+    m.base = NULL;
+    m.tamano = 0;
+}
+
+void soltarInstantanea() {
+    soltarMapeo(instantaneaActiva);
+}
+
+// Deja la base vaca: ndices, rbol, arena, textos e instantnea mapeada.
+void vaciarBase(Persona* &arbol) {
+    cambiosBase++;
+    desactivarHistorial();
+    inicializarTabla();
+    vaciarIndiceHijos();
+    vaciarIndiceNombres();
+    vaciarIndiceFechas();
+    vaciarAlmacen();
+    liberarArbol(arbol);
+    liberarMonticulo();
+    soltarInstantanea();
+}
+
+// Escribe la base completa (se escribe en ruta.tmp y luego se renombra, as
+// una cada a mitad de camino no deja una instantnea a medias).
+bool guardarInstantanea(const char* ruta) {
+    string temporal = string(ruta) + ".tmp";
+    FILE* archivo = fopen(temporal.c_str(), "wb");
+    if (archivo == NULL) return false;
+
+    // ndice de registro de cada persona viva, por celda (la tabla ya est
+    // ordenada por ID).
+    int limite = limiteCeldas();
+    int* indice = new int[limite > 0 ? limite : 1];
+    long long cantidad = 0, bytesTexto = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        indice[p->celda] = (int)cantidad++;
+        bytesTexto += p->nombre.largo;
+    }
+
+    CabeceraInstantanea cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magia, MAGIA_INSTANTANEA, sizeof(cab.magia));
+    cab.version = VERSION_INSTANTANEA;
+    cab.tamRegistro = sizeof(RegistroInstantanea);
+    cab.cantidad = cantidad;
+    cab.proximoID = proximoID;
+    cab.bytesTexto = bytesTexto;
+    cab.ultimaOperacion = registroOps.secuencia;
+    bool ok = fwrite(&cab, sizeof(cab), 1, archivo) == 1;
+
+    long long desplazamiento = 0;
+    for (int i = 0; i < tablaGlobal.cantidad && ok; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        RegistroInstantanea r;
+        r.id = p->id;
+        r.fecha = p->fecha_nac.valor;
+        r.padre = estaViva(p->padre) ? indice[p->padre->celda] : -1;
+        r.madre = estaViva(p->madre) ? indice[p->madre->celda] : -1;
+        r.nombreInicio = desplazamiento;
+        r.nombreLargo = p->nombre.largo;
+        r.relleno = 0;
+        desplazamiento += p->nombre.largo;
+        ok = fwrite(&r, sizeof(r), 1, archivo) == 1;
+    }
+    for (int i = 0; i < tablaGlobal.cantidad && ok; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL || p->nombre.largo == 0) continue;
+        ok = fwrite(p->nombre.datos, p->nombre.largo, 1, archivo) == 1;
+    }
+
+    delete[] indice;
+    ok = ok && fflush(archivo) == 0 && !ferror(archivo);
+    if (ok) {
+#ifndef _WIN32
+        sincronizarDisco(fileno(archivo));
+#else
+        sincronizarDisco(_fileno(archivo));
+#endif
+    }
+    ok = (fclose(archivo) == 0) && ok;
+    if (!ok) {
+        remove(temporal.c_str());
+        return false;
+    }
+    if (!reemplazarArchivo(temporal.c_str(), ruta)) {
+        remove(temporal.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool mapearArchivo(const char* ruta, InstantaneaMapeada &m) {
+#ifndef _WIN32
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* base = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return false;
+    m.base = (char*)base;
+    m.tamano = info.st_size;
+    m.mapeada = true;
+    return true;
+#else
+    FILE* archivo = fopen(ruta, "rb");
+    if (archivo == NULL) return false;
+    fseek(archivo, 0, SEEK_END);
+    long tam = ftell(archivo);
+    fseek(archivo, 0, SEEK_SET);
+    m.base = new char[tam > 0 ? tam : 1];
+    m.tamano = fread(m.base, 1, tam, archivo);
+    m.mapeada = false;
+    fclose(archivo);
+    return m.tamano == (size_t)tam && tam > 0;
+#endif
+}
+
+// Comprueba la cabecera y cada registro antes de tocar la base: un archivo
+// daado o ajeno no debe dejar punteros ni nombres fuera del mapeo. Los
+// tamaos se comparan restando, para que cantidades enormes no desborden.
+bool instantaneaValida(const InstantaneaMapeada &m) {
+    if (m.tamano < sizeof(CabeceraInstantanea)) return false;
+    const CabeceraInstantanea* cab = (const CabeceraInstantanea*)m.base;
+    if (memcmp(cab->magia, MAGIA_INSTANTANEA, sizeof(cab->magia)) != 0
+        || cab->version < 1 || cab->version > VERSION_INSTANTANEA
+        || cab->tamRegistro != sizeof(RegistroInstantanea)
+        || cab->cantidad < 0 || cab->bytesTexto < 0
+        || cab->proximoID < 0 || cab->proximoID > (long long)ID_MAXIMO + 1
+        || cab->ultimaOperacion < 0) {
+        return false;
+    }
+    unsigned long long resto = m.tamano - sizeof(CabeceraInstantanea);
+    if ((unsigned long long)cab->cantidad > resto / sizeof(RegistroInstantanea)) return false;
+    resto -= (unsigned long long)cab->cantidad * sizeof(RegistroInstantanea);
+    if ((unsigned long long)cab->bytesTexto > resto) return false;
+
+    long long n = cab->cantidad;
+    const RegistroInstantanea* registros = (const RegistroInstantanea*)(m.base + sizeof(CabeceraInstantanea));
+    for (long long i = 0; i < n; i++) {
+        const RegistroInstantanea &r = registros[i];
+        // Ordenados por ID sin repetir: el rbol se arma balanceado a partir
+        // de este orden, y un ID repetido corrompera el almacn.
+        if (r.id < 0 || r.id > ID_MAXIMO || (i > 0 && r.id <= registros[i - 1].id)) return false;
+        if (r.padre < -1 || r.padre >= n || r.madre < -1 || r.madre >= n) return false;
+        if (r.nombreLargo < 0 || r.nombreInicio < 0
+            || r.nombreInicio > cab->bytesTexto - r.nombreLargo) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reemplaza la base actual por la instantnea. Sin anlisis de texto ni
+// reservas por persona: los nodos salen de la arena en bloque, los nombres
+// apuntan al archivo y el rbol se arma balanceado en O(n). Si el archivo no
+// pasa la validacin, la base queda como estaba.
+bool cargarInstantanea(Persona* &arbol, const char* ruta) {
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+
+    InstantaneaMapeada m;
+    if (!mapearArchivo(ruta, m)) return false;
+    if (!instantaneaValida(m)) {
+        soltarMapeo(m);
+        return false;
+    }
+    CabeceraInstantanea* cab = (CabeceraInstantanea*)m.base;
+
+    vaciarBase(arbol);
+    instantaneaActiva = m;
+
+    long n = (long)cab->cantidad;
+    RegistroInstantanea* registros = (RegistroInstantanea*)(m.base + sizeof(CabeceraInstantanea));
+    const char* texto = (const char*)(registros + n);
+
+    Persona** nodos = new Persona*[n > 0 ? n : 1];
+    for (long i = 0; i < n; i++) {
+        Cadena nombre;
+        nombre.datos = texto + registros[i].nombreInicio;
+        nombre.largo = registros[i].nombreLargo;
+        Fecha fecha;
+        fecha.valor = registros[i].fecha;
+        nodos[i] = crearPersona(registros[i].id, nombre, fecha);
+        registrarEnAlmacen(nodos[i]);
+        agregarATabla(nodos[i]);
+        indexarNombre(nodos[i]);
+    }
+    for (long i = 0; i < n; i++) {
+        if (registros[i].padre >= 0) nodos[i]->padre = nodos[registros[i].padre];
+        if (registros[i].madre >= 0) nodos[i]->madre = nodos[registros[i].madre];
+    }
+    construirIndiceHijos(nodos, n);
+    construirIndiceFechas(nodos, n);
+    calcularGeneraciones(nodos, n);
+    calcularProfundidades(nodos, n);
+    cambiosBase++;
+
+    arbol = construirArbolBalanceado(nodos, 0, n - 1);
+    estadisticasAVL.nodos = n;
+    proximoID = (int)cab->proximoID;
+    registroOps.secuencia = cab->ultimaOperacion;
+
+    delete[] nodos;
+    msUltimaCarga = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+    return true;
+}
+
+// Reaplica sobre la base cargada las operaciones que la instantnea no
+// contiene. Se detiene en el primer registro incompleto o con CRC incorrecto
+// y recorta el archivo ah, para que lo nuevo no quede detrs de basura.
+// RETORNO: cantidad de operaciones reaplicadas.
+long reaplicarRegistro(Persona* &arbol, const char* ruta) {
+    InstantaneaMapeada m;
+    if (!mapearArchivo(ruta, m)) return 0;
+
+    registroOps.reaplicando = true;
+    long aplicadas = 0;
+    size_t pos = 0;
+    while (pos + sizeof(CabeceraOperacion) <= m.tamano) {
+        CabeceraOperacion cab;
+        memcpy(&cab, m.base + pos, sizeof(cab));
+        if (cab.largoNombre < 0 || cab.largo != sizeof(cab) + cab.largoNombre
+            || pos + cab.largo > m.tamano
+            || calcularCRC32(m.base + pos + sizeof(cab.crc), cab.largo - sizeof(cab.crc)) != cab.crc) {
+            break;
+        }
+        if (cab.secuencia > registroOps.secuencia) {
+            if (cab.tipo == OPERACION_ALTA) {
+                Fecha fecha;
+                fecha.valor = cab.fecha;
+                Persona* p = agregarPersona(arbol, cab.id,
+                                            guardarCadena(m.base + pos + sizeof(cab), cab.largoNombre), fecha,
+                                            cab.padre >= 0 ? buscarPorID(cab.padre) : NULL,
+                                            cab.madre >= 0 ? buscarPorID(cab.madre) : NULL);
+                if (p != NULL) considerarID(p);
+            } else if (cab.tipo == OPERACION_BAJA) {
+                quitarPersona(arbol, cab.id);
+            } else if (cab.tipo == OPERACION_PADRES) {
+                asignarPadres(buscarPorID(cab.id),
+                              cab.padre >= 0 ? buscarPorID(cab.padre) : NULL,
+                              cab.madre >= 0 ? buscarPorID(cab.madre) : NULL);
+            }
+            registroOps.secuencia = cab.secuencia;
+            aplicadas++;
+        }
+        pos += cab.largo;
+    }
+    bool colaRota = pos < m.tamano;
+    soltarMapeo(m);
+    registroOps.reaplicando = false;
+
+    if (colaRota) {
+        int fd = abrirParaAnexar(ruta);
+        if (fd >= 0) {
+            truncarDescriptor(fd, pos);
+            cerrarDescriptor(fd);
+        }
+    }
+    return aplicadas;
+}
+
+// Guarda la instantnea y vaca el registro: todo lo anotado ya est en ella.
+// Si la cada ocurre entre ambos pasos, la reaplicacin saltea lo que la
+// instantnea ya tiene gracias a ultimaOperacion.
+bool puntoDeControl(const char* rutaInstantanea) {
+    if (!guardarInstantanea(rutaInstantanea)) return false;
+    if (registroOps.abierto) {
+        lock_guard<mutex> cerrojo(registroOps.cerrojo);
+        truncarDescriptor(registroOps.fd, 0);
+        registroOps.pendiente = false;
+        registroOps.sinAnotar = false;
+    }
+    return true;
+}
+
+// Si una alta, baja o cambio de padres no lleg al registro, la nica forma
+// de que sobreviva a un reinicio es una instantnea nueva: se fuerza el punto
+// de control en ese momento.
+// RETORNO: false si tampoco se pudo guardar la instantnea.
+bool asegurarRegistro() {
+    if (!registroOps.sinAnotar) return true;
+    return puntoDeControl(ARCHIVO_INSTANTANEA);
+}
+
+// Mide el costo de n altas con cada poltica sobre un registro temporal.
+void medirRegistro(long n) {
+    const char* ruta = "bench.wal";
+    PoliticaSync politicas[3] = {SYNC_SIEMPRE, SYNC_GRUPO, SYNC_NUNCA};
+
+    cout << "Altas por politica de sincronizacion (" << n << " operaciones, grupo cada "
+         << intervaloSyncMs << " ms)\n\n";
+    cout << left << setw(10) << "politica" << right << setw(14) << "altas/s"
+         << setw(12) << "us/alta" << setw(10) << "fsync" << "\n";
+    for (int k = 0; k < 3; k++) {
+        Persona* arbol = NULL;
+        remove(ruta);
+        registroOps.secuencia = 0;
+        if (!abrirRegistro(ruta, politicas[k], intervaloSyncMs)) {
+            cout << "No se pudo crear " << ruta << "\n";
+            return;
+        }
+        Cadena nombre = guardarCadena("Persona de prueba");
+        Fecha fecha = empaquetarFecha(1, 1, 1990);
+
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+        for (long i = 1; i <= n; i++) {
+            agregarPersona(arbol, (int)i, nombre, fecha, i > 1 ? buscarPorID((int)(i / 2)) : NULL, NULL);
+        }
+        cerrarRegistro();
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+        cout << left << setw(10) << nombrePolitica(politicas[k]) << right << fixed
+             << setw(14) << setprecision(0) << n / segundos
+             << setw(12) << setprecision(2) << segundos * 1e6 / n
+             << setw(10) << registroOps.sincronizaciones << "\n";
+        vaciarBase(arbol);
+    }
+    remove(ruta);
+}
+
+// =============================================================================
+// SALIDA CON BUFFER
+// Los listados grandes se arman en un buffer propio de 1 MB, con enteros y
+// fechas formateados a mano, y salen con un fwrite por buffer lleno en lugar
+// de pasar fila por fila por cout. Antes de volver a usar cout hay que
+// vaciar la salida (terminarListado lo hace).
+// =============================================================================
+const int TAM_SALIDA = 1 << 20;
+
+struct Salida {
+    char* datos;                    // Se reserva con la primera escritura
+    int usados;
+    FILE* destino;                  // NULL = stdout
+};
+
+Salida salidaEstandar = {NULL, 0, NULL};
+
+void vaciarSalida(Salida &s) {
+    if (s.usados > 0) fwrite(s.datos, 1, s.usados, s.destino != NULL ? s.destino : stdout);
+    s.usados = 0;
+}
+
+void liberarSalida(Salida &s) {
+    vaciarSalida(s);
+    fflush(s.destino != NULL ? s.destino : stdout);
+    delete[] s.datos;
+    s.datos = NULL;
+}
+
+// Garantiza n bytes libres (n <= TAM_SALIDA).
+void reservarSalida(Salida &s, int n) {
+    if (s.datos == NULL) {
+        s.datos = new char[TAM_SALIDA];
+        s.usados = 0;
+    }
+    if (s.usados + n > TAM_SALIDA) vaciarSalida(s);
+}
+
+void escribirBytes(Salida &s, const char* texto, int n) {
+    if (n > TAM_SALIDA / 2) {
+        reservarSalida(s, 0);
+        vaciarSalida(s);
+        fwrite(texto, 1, n, s.destino != NULL ? s.destino : stdout);
+        return;
+    }
+    reservarSalida(s, n);
+    memcpy(s.datos + s.usados, texto, n);
+    s.usados += n;
+}
+
+void escribirTexto(Salida &s, const char* texto) {
+    escribirBytes(s, texto, (int)strlen(texto));
+}
+
+void escribirCaracter(Salida &s, char c) {
+    reservarSalida(s, 1);
+    s.datos[s.usados++] = c;
+}
+
+void escribirEntero(Salida &s, long long valor) {
+    char cifras[24];
+    int n = 0;
+    unsigned long long v = valor < 0 ? 0ULL - (unsigned long long)valor : (unsigned long long)valor;
+    do {
+        cifras[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    if (valor < 0) cifras[n++] = '-';
+    reservarSalida(s, n);
+    while (n > 0) s.datos[s.usados++] = cifras[--n];
+}
+
+void escribirRelleno(Salida &s, int n) {
+    if (n <= 0) return;
+    reservarSalida(s, n);
+    memset(s.datos + s.usados, ' ', n);
+    s.usados += n;
+}
+
+// Cadena alineada a la izquierda en un ancho mnimo (como setw + left).
+void escribirCadena(Salida &s, Cadena c, int ancho = 0) {
+    escribirBytes(s, c.datos, c.largo);
+    escribirRelleno(s, ancho - c.largo);
+}
+
+void escribirEnteroAncho(Salida &s, long long valor, int ancho) {
+    reservarSalida(s, 24 + ancho);
+    int antes = s.usados;
+    escribirEntero(s, valor);
+    escribirRelleno(s, ancho - (s.usados - antes));
+}
+
+// Nmero con una cantidad fija de decimales (redondeado), como fixed + setprecision.
+void escribirDecimal(Salida &s, double valor, int decimales) {
+    if (valor < 0) {
+        escribirCaracter(s, '-');
+        valor = -valor;
+    }
+    long long escala = 1;
+    for (int i = 0; i < decimales; i++) escala *= 10;
+    long long total = (long long)(valor * escala + 0.5);
+    escribirEntero(s, total / escala);
+    if (decimales == 0) return;
+    escribirCaracter(s, '.');
+    long long fraccion = total % escala;
+    for (long long d = escala / 10; d > 0; d /= 10) {
+        escribirCaracter(s, (char)('0' + (fraccion / d) % 10));
+    }
+}
+
+void escribirFecha(Salida &s, Fecha f) {
+    reservarSalida(s, 11);
+    formatearFecha(f, s.datos + s.usados);
+    s.usados += 10;
+}
+
+// Texto JSON entre comillas; los bytes >= 0x80 pasan tal cual.
+void escribirCadenaJSON(Salida &s, Cadena c) {
+    escribirCaracter(s, '"');
+    for (int i = 0; i < c.largo; i++) {
+        unsigned char ch = (unsigned char)c.datos[i];
+        if (ch == '"' || ch == '\\') {
+            escribirCaracter(s, '\\');
+            escribirCaracter(s, (char)ch);
+        } else if (ch < 0x20) {
+            const char* hex = "0123456789abcdef";
+            escribirTexto(s, "\\u00");
+            escribirCaracter(s, hex[ch >> 4]);
+            escribirCaracter(s, hex[ch & 15]);
+        } else {
+            escribirCaracter(s, (char)ch);
+        }
+    }
+    escribirCaracter(s, '"');
+}
+
+// =============================================================================
+// LISTADOS DE PERSONAS
+// Formatos: tabla con recuadro, TSV (id, nombre, fecha, padre, madre; "-"
+// cuando falta el dato), JSON (arreglo de objetos) y lnea simple
+// "[id] nombre (fecha)" de los recorridos. Paginacin: se saltean las
+// primeras 'desde' filas y se emiten como mucho 'limite' (0 = todas).
+// =============================================================================
+enum FormatoListado { LISTADO_TABLA, LISTADO_TSV, LISTADO_JSON, LISTADO_LINEA };
+
+struct Listado {
+    Salida* salida;
+    FormatoListado formato;
+    const char* prefijo;            // TSV: campo inicial de cada fila (modo por lotes)
+    long desde;
+    long limite;
+    long vistas;                    // Filas ofrecidas, incluidas las salteadas
+    long emitidas;
+};
+
+Listado listado;
+
+void comenzarListado(Salida &s, FormatoListado formato, long desde = 0, long limite = 0, const char* prefijo = NULL) {
+    listado.salida = &s;
+    listado.formato = formato;
+    listado.prefijo = prefijo;
+    listado.desde = desde > 0 ? desde : 0;
+    listado.limite = limite > 0 ? limite : 0;
+    listado.vistas = 0;
+    listado.emitidas = 0;
+    
+    if (formato == LISTADO_TABLA) {
+        escribirTexto(s, "\n+----------------------------------------------------------------------------+\n");
+        escribirTexto(s, "                          TABLA DE PERSONAS                                  \n");
+        escribirTexto(s, "----------------------------------------------------------------------------\n");
+        escribirTexto(s, " ID   NOMBRE                FECHA NACIMIENTO  PADRE   MADRE             \n");
+        escribirTexto(s, "----------------------------------------------------------------------------\n");
+    } else if (formato == LISTADO_TSV && prefijo == NULL) {
+        escribirTexto(s, "id\tnombre\tfecha\tpadre\tmadre\n");
+    } else if (formato == LISTADO_JSON) {
+        escribirCaracter(s, '[');
+    }
+}
+
+bool listadoCompleto() {
+    return listado.limite > 0 && listado.emitidas >= listado.limite;
+}
+
+// RETORNO: true si la fila que sigue cae dentro de la pgina.
+bool filaEnPagina() {
+    return listado.vistas++ >= listado.desde && !listadoCompleto();
+}
+
+void escribirIDPariente(Salida &s, Persona* p) {
+    if (p != NULL) escribirEntero(s, p->id);
+    else escribirCaracter(s, '-');
+}
+
+void escribirFilaTabla(Salida &s, Persona* p) {
+    escribirTexto(s, " ");
+    escribirEnteroAncho(s, p->id, 3);
+    escribirTexto(s, "  ");
+    escribirCadena(s, p->nombre, 21);
+    escribirTexto(s, " ");
+    escribirFecha(s, p->fecha_nac);
+    escribirRelleno(s, 7);
+    escribirTexto(s, " ");
+    if (p->padre != NULL) escribirEnteroAncho(s, p->padre->id, 7);
+    else escribirTexto(s, "N/A    ");
+    escribirTexto(s, " ");
+    if (p->madre != NULL) escribirCadena(s, p->madre->nombre, 18);
+    else escribirTexto(s, "N/A               ");
+    escribirTexto(s, "\n");
+}
+
+void escribirFilaTSV(Salida &s, Persona* p, const char* prefijo) {
+    if (prefijo != NULL) {
+        escribirTexto(s, prefijo);
+        escribirCaracter(s, '\t');
+    }
+    escribirEntero(s, p->id);
+    escribirCaracter(s, '\t');
+    escribirCadena(s, p->nombre);
+    escribirCaracter(s, '\t');
+    if (p->fecha_nac == FECHA_DESCONOCIDA) escribirCaracter(s, '-');
+    else escribirFecha(s, p->fecha_nac);
+    escribirCaracter(s, '\t');
+    escribirIDPariente(s, p->padre);
+    escribirCaracter(s, '\t');
+    escribirIDPariente(s, p->madre);
+    escribirCaracter(s, '\n');
+}
+
+void escribirFilaJSON(Salida &s, Persona* p, bool primera) {
+    escribirTexto(s, primera ? "\n  {\"id\": " : ",\n  {\"id\": ");
+    escribirEntero(s, p->id);
+    escribirTexto(s, ", \"nombre\": ");
+    escribirCadenaJSON(s, p->nombre);
+    escribirTexto(s, ", \"fecha\": ");
+    if (p->fecha_nac == FECHA_DESCONOCIDA) {
+        escribirTexto(s, "null");
+    } else {
+        escribirCaracter(s, '"');
+        escribirFecha(s, p->fecha_nac);
+        escribirCaracter(s, '"');
+    }
+    escribirTexto(s, ", \"padre\": ");
+    if (p->padre != NULL) escribirEntero(s, p->padre->id); else escribirTexto(s, "null");
+    escribirTexto(s, ", \"madre\": ");
+    if (p->madre != NULL) escribirEntero(s, p->madre->id); else escribirTexto(s, "null");
+    escribirCaracter(s, '}');
+}
+
+void escribirFilaLinea(Salida &s, Persona* p) {
+    escribirCaracter(s, '[');
+    escribirEntero(s, p->id);
+    escribirTexto(s, "] ");
+    escribirCadena(s, p->nombre);
+    escribirTexto(s, " (");
+    escribirFecha(s, p->fecha_nac);
+    escribirCaracter(s, ')');
+}
+
+// Visita compatible con los recorridos: emite la persona si cae en la pgina.
+// RETORNO: false cuando la pgina se complet, para detener el recorrido.
+bool listarPersona(Persona* p) {
+    if (!filaEnPagina()) return !listadoCompleto();
+    Salida &s = *listado.salida;
+    switch (listado.formato) {
+        case LISTADO_TABLA: escribirFilaTabla(s, p); break;
+        case LISTADO_TSV:   escribirFilaTSV(s, p, listado.prefijo); break;
+        case LISTADO_JSON:  escribirFilaJSON(s, p, listado.emitidas == 0); break;
+        case LISTADO_LINEA:
+            escribirFilaLinea(s, p);
+            escribirCaracter(s, '\n');
+            break;
+    }
+    listado.emitidas++;
+    return !listadoCompleto();
+}
+
+// vaciar = false deja el texto en el buffer (el modo por lotes vaca al final).
+void terminarListado(bool vaciar = true) {
+    Salida &s = *listado.salida;
+    if (listado.formato == LISTADO_TABLA) {
+        escribirTexto(s, "+----------------------------------------------------------------------------+\n");
+    } else if (listado.formato == LISTADO_JSON) {
+        escribirTexto(s, listado.emitidas > 0 ? "\n]\n" : "]\n");
+    }
+    if (vaciar) {
+        vaciarSalida(s);
+        fflush(s.destino != NULL ? s.destino : stdout);
+    }
+}
+
+// Lista la pgina en orden de ID empezando directamente en la fila desde:
+// la tabla, compactada, tiene a las personas vivas en ese orden, as que la
+// fila k es la casilla k y no hace falta contar las anteriores.
+void listarTablaDesdeFila() {
+    if (tablaGlobal.huecos > 0) compactarTabla();
+    listado.vistas = listado.desde;
+    for (long i = listado.desde; i < tablaGlobal.cantidad; i++) {
+        if (!listarPersona(tablaGlobal.personas[i])) break;
+    }
+}
+
+// Emite la pgina pedida con el recorrido dado. El inorden es el orden por
+// ID, as que salta a la primera fila en lugar de recorrer las anteriores.
+void listarConRecorrido(Persona* raiz, void (*recorrer)(Persona*, VisitaPersona)) {
+    if ((recorrer == recorrerInorden || recorrer == recorrerInordenMorris) && listado.desde > 0) {
+        listarTablaDesdeFila();
+    } else {
+        recorrer(raiz, listarPersona);
+    }
+}
+
+void mostrarTabla(FormatoListado formato = LISTADO_TABLA, long desde = 0, long limite = 0) {
+    cout.flush();
+    comenzarListado(salidaEstandar, formato, desde, limite);
+    listarTablaDesdeFila();
+    terminarListado();
+}
+
+// =============================================================================
+// CIERRE DE ANCESTROS
+// Con matrimonios entre parientes un mismo ancestro aparece por varios
+// caminos y recorrerlos todos crece exponencialmente con las generaciones.
+// El cierre visita cada ancestro una sola vez (marcas por celda) y despus
+// propaga, en orden topolgico, el conjunto de distancias por las que se
+// llega a cada uno: bit k de la mscara = ancestro a k generaciones.
+// El bit 63 se satura y significa "63 o ms generaciones"; la distancia
+// mnima siempre es exacta.
+// =============================================================================
+const unsigned long long BIT_DISTANCIA_SATURADA = 1ULL << 63;
+
+struct CierreAncestros {
+    ListaEnteros ids;                   // ids.datos[0] es la persona consultada
+    int* distanciaMinima;               // Paralelos a ids
+    unsigned long long* generaciones;
+    int capacidad;
+};
+
+MarcasVisita marcasAncestros;
+int* posicionEnCierre = NULL;           // Celda -> posicin en el cierre (vlido si est marcada)
+int capacidadPosiciones = 0;
+
+void inicializarCierre(CierreAncestros &c) {
+    inicializarEnteros(c.ids);
+    c.distanciaMinima = NULL;
+    c.generaciones = NULL;
+    c.capacidad = 0;
+}
+
+void liberarCierre(CierreAncestros &c) {
+    liberarEnteros(c.ids);
+    delete[] c.distanciaMinima;
+    delete[] c.generaciones;
+    c.distanciaMinima = NULL;
+    c.generaciones = NULL;
+    c.capacidad = 0;
+}
+
+int agregarAlCierre(CierreAncestros &c, Persona* p, int distancia) {
+    agregarEntero(c.ids, p->id);
+    if (c.ids.capacidad > c.capacidad) {
+        int* dist = new int[c.ids.capacidad];
+        unsigned long long* gen = new unsigned long long[c.ids.capacidad];
+        for (int i = 0; i < c.ids.cantidad - 1; i++) {
+            dist[i] = c.distanciaMinima[i];
+            gen[i] = c.generaciones[i];
+        }
+        delete[] c.distanciaMinima;
+        delete[] c.generaciones;
+        c.distanciaMinima = dist;
+        c.generaciones = gen;
+        c.capacidad = c.ids.capacidad;
+    }
+    int pos = c.ids.cantidad - 1;
+    c.distanciaMinima[pos] = distancia;
+    c.generaciones[pos] = 0;
+    posicionEnCierre[p->celda] = pos;
+    return pos;
+}
+
+// Llena c con los ancestros de persona (la persona incluida, a distancia 0).
+// profundidadMax = 0 no limita las generaciones.
+void calcularAncestros(Persona* persona, CierreAncestros &c, int profundidadMax = 0) {
+    c.ids.cantidad = 0;
+    if (persona == NULL) return;
+
+    int limite = limiteCeldas();
+    nuevaVisita(marcasAncestros, limite);
+    if (limite > capacidadPosiciones) {
+        delete[] posicionEnCierre;
+        posicionEnCierre = new int[limite];
+        capacidadPosiciones = limite;
+    }
+
+    // 1) BFS: cada ancestro entra una sola vez, con su distancia mnima.
+    //    pendientes[i] = aristas hijo->progenitor exploradas que llegan a i.
+    ListaEnteros pendientes;
+    inicializarEnteros(pendientes);
+    marcarVisitado(marcasAncestros, persona->celda);
+    agregarAlCierre(c, persona, 0);
+    agregarEntero(pendientes, 0);
+
+    for (int i = 0; i < c.ids.cantidad; i++) {
+        if (profundidadMax > 0 && c.distanciaMinima[i] >= profundidadMax) continue;
+        Persona* p = buscarPorID(c.ids.datos[i]);
+        Persona* progenitores[2] = {p->padre, p->madre};
+        for (int k = 0; k < 2; k++) {
+            Persona* pr = progenitores[k];
+            if (pr == NULL || (k == 1 && pr == p->padre)) continue;
+            if (marcarVisitado(marcasAncestros, pr->celda)) {
+                agregarAlCierre(c, pr, c.distanciaMinima[i] + 1);
+                agregarEntero(pendientes, 0);
+            }
+            pendientes.datos[posicionEnCierre[pr->celda]]++;
+        }
+    }
+
+    // 2) Kahn: un ancestro se procesa cuando ya recibi todas las distancias
+    //    de sus descendientes dentro del cierre.
+    ListaEnteros listos;
+    inicializarEnteros(listos);
+    c.generaciones[0] = 1;
+    agregarEntero(listos, 0);
+    while (listos.cantidad > 0) {
+        int i = listos.datos[--listos.cantidad];
+        if (profundidadMax > 0 && c.distanciaMinima[i] >= profundidadMax) continue;
+        Persona* p = buscarPorID(c.ids.datos[i]);
+        Persona* progenitores[2] = {p->padre, p->madre};
+        for (int k = 0; k < 2; k++) {
+            Persona* pr = progenitores[k];
+            if (pr == NULL || (k == 1 && pr == p->padre)) continue;
+            int j = posicionEnCierre[pr->celda];
+            unsigned long long gen = c.generaciones[i];
+            c.generaciones[j] |= (gen << 1) | (gen & BIT_DISTANCIA_SATURADA);
+            if (--pendientes.datos[j] == 0) agregarEntero(listos, j);
+        }
+    }
+
+    liberarEnteros(pendientes);
+    liberarEnteros(listos);
+}
+
+// =============================================================================
+// FUNCIN: mostrarAncestros
+// Dibuja el rbol de ancestros con una pila explcita, lnea por lnea.
+// Un ancestro ya desarrollado se marca como repetido y no se expande otra
+// vez, as el dibujo crece con los ancestros distintos y no con los caminos.
+// Con tope de profundidad, uno que llega al tope se imprime sin marcar y
+// uno desarrollado en un nivel ms bajo vuelve a desarrollarse si aparece
+// ms arriba, para no esconder generaciones que entran bajo el tope.
+// =============================================================================
+int* nivelDesarrollo = NULL;        // Celda -> nivel donde se desarroll (vlido si est marcada)
+int capacidadNiveles = 0;
+
+void mostrarAncestros(Persona* persona, int profundidadMax = 0) {
     if (persona == NULL) return;
     
-    for (int i = 0; i < nivel; i++) cout << "  ";
-    cout << persona->nombre << endl;
+    int limite = limiteCeldas();
+    nuevaVisita(marcasAncestros, limite);
+    if (profundidadMax > 0 && limite > capacidadNiveles) {
+        delete[] nivelDesarrollo;
+        nivelDesarrollo = new int[limite];
+        capacidadNiveles = limite;
+    }
+    
+    // Cada entrada de la pila: ID, nivel y rol (0 = raz, 1 = padre, 2 = madre).
+    ListaEnteros pilaIds, pilaNiveles, pilaRoles;
+    inicializarEnteros(pilaIds);
+    inicializarEnteros(pilaNiveles);
+    inicializarEnteros(pilaRoles);
+    agregarEntero(pilaIds, persona->id);
+    agregarEntero(pilaNiveles, 0);
+    agregarEntero(pilaRoles, 0);
     
-    if (persona->padre != NULL) {
+    while (pilaIds.cantidad > 0) {
+        int id = pilaIds.datos[--pilaIds.cantidad];
+        int nivel = pilaNiveles.datos[--pilaNiveles.cantidad];
+        int rol = pilaRoles.datos[--pilaRoles.cantidad];
+        Persona* p = buscarPorID(id);
+        
         for (int i = 0; i < nivel; i++) cout << "  ";
-        cout << "+- Padre: ";
-        mostrarAncestros(persona->padre, nivel + 1);
+        if (rol == 1) cout << "+- Padre: ";
+        if (rol == 2) cout << "+- Madre: ";
+        cout << p->nombre << " [" << id << "]";
+        
+        if (visitado(marcasAncestros, p->celda) &&
+            (profundidadMax == 0 || nivelDesarrollo[p->celda] <= nivel)) {
+            cout << " (repetido, ver arriba)\n";
+            continue;
+        }
+        cout << "\n";
+        if (profundidadMax > 0 && nivel >= profundidadMax) continue;
+        marcarVisitado(marcasAncestros, p->celda);
+        if (profundidadMax > 0) nivelDesarrollo[p->celda] = nivel;
+        
+        if (p->madre != NULL) {
+            agregarEntero(pilaIds, p->madre->id);
+            agregarEntero(pilaNiveles, nivel + 1);
+            agregarEntero(pilaRoles, 2);
+        }
+        if (p->padre != NULL) {
+            agregarEntero(pilaIds, p->padre->id);
+            agregarEntero(pilaNiveles, nivel + 1);
+            agregarEntero(pilaRoles, 1);
+        }
+    }
+    
+    liberarEnteros(pilaIds);
+    liberarEnteros(pilaNiveles);
+    liberarEnteros(pilaRoles);
+}
+
+// Resumen del cierre: total de ancestros distintos y los que se alcanzan
+// por caminos de distinta longitud (colapso de pedigr).
+void mostrarResumenAncestros(Persona* persona, int profundidadMax = 0) {
+    CierreAncestros c;
+    inicializarCierre(c);
+    calcularAncestros(persona, c, profundidadMax);
+    
+    int maxGen = 0;
+    for (int i = 1; i < c.ids.cantidad; i++) {
+        if (c.distanciaMinima[i] > maxGen) maxGen = c.distanciaMinima[i];
+    }
+    cout << "\n Ancestros distintos: " << (c.ids.cantidad > 0 ? c.ids.cantidad - 1 : 0)
+         << " (hasta " << maxGen << " generaciones)\n";
+    
+    for (int i = 1; i < c.ids.cantidad; i++) {
+        unsigned long long gen = c.generaciones[i];
+        if ((gen & (gen - 1)) == 0) continue;   // Una sola distancia
+        cout << "  " << buscarPorID(c.ids.datos[i])->nombre << " [" << c.ids.datos[i] << "]: generaciones";
+        for (int k = 0; k < 64; k++) {
+            if (gen & (1ULL << k)) cout << " " << k;
+        }
+        if (gen & BIT_DISTANCIA_SATURADA) cout << "+";
+        cout << "\n";
+    }
+    liberarCierre(c);
+}
+
+// =============================================================================
+// FUNCIN: mostrarDescendientes
+// Recorre el ndice de hijos en profundidad con una pila explcita: el costo
+// es proporcional a los descendientes impresos. Quien desciende por dos
+// caminos (hijos de primos, por ejemplo) se imprime una sola vez.
+// profundidadMax = 0 muestra todas las generaciones.
+// =============================================================================
+MarcasVisita marcasDescendientes;
+
+void mostrarDescendientes(Persona* persona, int profundidadMax = 0) {
+    if (persona == NULL) return;
+    
+    cout << "Descendientes de " << persona->nombre << ":\n";
+    if (cantidadHijos(persona->id) == 0) {
+        cout << "  (sin hijos registrados)\n";
+        return;
+    }
+    
+    nuevaVisita(marcasDescendientes, limiteCeldas());
+    marcarVisitado(marcasDescendientes, persona->celda);
+    
+    ListaEnteros pilaIds, pilaNiveles;
+    inicializarEnteros(pilaIds);
+    inicializarEnteros(pilaNiveles);
+    agregarEntero(pilaIds, persona->id);
+    agregarEntero(pilaNiveles, 0);
+    
+    while (pilaIds.cantidad > 0) {
+        int id = pilaIds.datos[--pilaIds.cantidad];
+        int nivel = pilaNiveles.datos[--pilaNiveles.cantidad];
+        
+        if (nivel > 0) {
+            Persona* d = buscarPorID(id);
+            for (int i = 1; i < nivel; i++) cout << "  ";
+            cout << "- " << d->nombre << " [" << id << "]\n";
+        }
+        if (profundidadMax > 0 && nivel >= profundidadMax) continue;
+        
+        int n = cantidadHijos(id);
+        int* hijos = hijosDe(id);
+        for (int k = n - 1; k >= 0; k--) {
+            Persona* h = buscarPorID(hijos[k]);
+            if (h != NULL && marcarVisitado(marcasDescendientes, h->celda)) {
+                agregarEntero(pilaIds, hijos[k]);
+                agregarEntero(pilaNiveles, nivel + 1);
+            }
+        }
+    }
+    
+    liberarEnteros(pilaIds);
+    liberarEnteros(pilaNiveles);
+}
+
+// =============================================================================
+// PARENTESCO ENTRE DOS PERSONAS
+// Bsqueda bidireccional por generaciones sobre padre/madre: se sube por
+// turnos desde cada persona, siempre por el lado menos profundo, y cada
+// ancestro alcanzado desde los dos lados es un ancestro comn. Todo ancestro
+// comn que falte est al menos una generacin ms all del lado vivo menos
+// profundo, as que la bsqueda se corta en cuanto ninguno puede mejorar la
+// suma de distancias ya encontrada. Solo se recorre el entorno cercano de
+// las dos personas, no el cierre completo de sus ancestros.
+// Se informan los ancestros comunes ms cercanos (mnima suma de distancias):
+// ninguno de ellos es ancestro de otro, son los ancestros comunes ms bajos.
+// =============================================================================
+const int SIN_PARENTESCO = 1 << 30;
+
+struct Parentesco {
+    ListaEnteros comunes;           // IDs de los ancestros comunes ms cercanos
+    ListaEnteros distanciasA;       // Generaciones de A a cada uno
+    ListaEnteros distanciasB;
+    int distancia;                  // Suma mnima (grado civil); SIN_PARENTESCO si no hay
+    long visitados;                 // Ancestros explorados, de los dos lados
+};
+
+MarcasVisita marcasParentesco[2];
+int* distanciaParentesco[2] = {NULL, NULL};    // Celda -> generaciones (vlido si est marcada)
+int capacidadParentesco = 0;
+
+void inicializarParentesco(Parentesco &r) {
+    inicializarEnteros(r.comunes);
+    inicializarEnteros(r.distanciasA);
+    inicializarEnteros(r.distanciasB);
+    r.distancia = SIN_PARENTESCO;
+    r.visitados = 0;
+}
+
+void liberarParentesco(Parentesco &r) {
+    liberarEnteros(r.comunes);
+    liberarEnteros(r.distanciasA);
+    liberarEnteros(r.distanciasB);
+}
+
+void calcularParentesco(Persona* a, Persona* b, Parentesco &r) {
+    r.comunes.cantidad = 0;
+    r.distanciasA.cantidad = 0;
+    r.distanciasB.cantidad = 0;
+    r.distancia = SIN_PARENTESCO;
+    r.visitados = 0;
+    if (a == NULL || b == NULL) return;
+
+    int limite = limiteCeldas();
+    if (limite > capacidadParentesco) {
+        for (int lado = 0; lado < 2; lado++) {
+            delete[] distanciaParentesco[lado];
+            distanciaParentesco[lado] = new int[limite];
+        }
+        capacidadParentesco = limite;
+    }
+
+    // vistos[lado]: todo lo alcanzado desde ese lado; el ltimo tramo
+    // (desde inicioFrontera) es la generacin a expandir.
+    ListaEnteros vistos[2], encuentros;
+    inicializarEnteros(vistos[0]);
+    inicializarEnteros(vistos[1]);
+    inicializarEnteros(encuentros);
+
+    Persona* origen[2] = {a, b};
+    int profundidad[2] = {0, 0};
+    int inicioFrontera[2] = {0, 0};
+    int primerCandidato[2] = {0, 0};    // En vistos[otro lado]: los anteriores ya no acotan
+    for (int lado = 0; lado < 2; lado++) {
+        nuevaVisita(marcasParentesco[lado], limite);
+        marcarVisitado(marcasParentesco[lado], origen[lado]->celda);
+        distanciaParentesco[lado][origen[lado]->celda] = 0;
+        agregarEntero(vistos[lado], origen[lado]->id);
+    }
+    if (a == b) {
+        agregarEntero(encuentros, a->id);
+        r.distancia = 0;
+    }
+
+    while (true) {
+        bool vivo[2] = {inicioFrontera[0] < vistos[0].cantidad, inicioFrontera[1] < vistos[1].cantidad};
+        if (!vivo[0] && !vivo[1]) break;
+
+        // Cota de la suma de cualquier ancestro comn no encontrado todava.
+        // Se sigue mientras pueda empatar, para juntar a los dos padres de
+        // un hermano.
+        int cota = SIN_PARENTESCO;
+        if (vivo[0] && vivo[1]) cota = profundidad[0] + profundidad[1] + 2;
+        for (int lado = 0; lado < 2 && r.distancia < cota; lado++) {
+            if (!vivo[lado]) continue;
+            // Alcanzado solo desde el otro lado: desde ste estar a ms de
+            // profundidad[lado] generaciones, si es que es ancestro suyo, y
+            // la generacin dice cun lejos puede estar como mximo.
+            // vistos[otro] est en orden de distancia y quien deja de ser
+            // candidato (ya visto desde este lado, o demasiado cerca en
+            // generaciones) no vuelve a serlo: el mnimo es el primer
+            // candidato, y el puntero solo avanza.
+            int otro = 1 - lado;
+            int &i = primerCandidato[lado];
+            while (i < vistos[otro].cantidad) {
+                Persona* q = buscarPorID(vistos[otro].datos[i]);
+                if (!visitado(marcasParentesco[lado], q->celda)
+                    && origen[lado]->generacion - q->generacion > profundidad[lado]) {
+                    int suma = profundidad[lado] + 1 + distanciaParentesco[otro][q->celda];
+                    if (suma < cota) cota = suma;
+                    break;
+                }
+                i++;
+            }
+        }
+        if (r.distancia < cota) break;
+
+        int lado;
+        if (!vivo[0]) lado = 1;
+        else if (!vivo[1]) lado = 0;
+        else if (profundidad[0] != profundidad[1]) lado = (profundidad[0] < profundidad[1]) ? 0 : 1;
+        else lado = (vistos[0].cantidad - inicioFrontera[0] <= vistos[1].cantidad - inicioFrontera[1]) ? 0 : 1;
+
+        int nueva = profundidad[lado] + 1;
+        int fin = vistos[lado].cantidad;
+        for (int i = inicioFrontera[lado]; i < fin; i++) {
+            Persona* p = buscarPorID(vistos[lado].datos[i]);
+            Persona* progenitores[2] = {p->padre, p->madre};
+            for (int k = 0; k < 2; k++) {
+                Persona* pr = progenitores[k];
+                if (pr == NULL || (k == 1 && pr == p->padre)) continue;
+                if (!marcarVisitado(marcasParentesco[lado], pr->celda)) continue;
+                distanciaParentesco[lado][pr->celda] = nueva;
+                agregarEntero(vistos[lado], pr->id);
+                r.visitados++;
+                if (visitado(marcasParentesco[1 - lado], pr->celda)) {
+                    agregarEntero(encuentros, pr->id);
+                    int suma = nueva + distanciaParentesco[1 - lado][pr->celda];
+                    if (suma < r.distancia) r.distancia = suma;
+                }
+            }
+        }
+        inicioFrontera[lado] = fin;
+        profundidad[lado] = nueva;
+    }
+
+    for (int i = 0; i < encuentros.cantidad; i++) {
+        int id = encuentros.datos[i];
+        int celda = buscarPorID(id)->celda;
+        int da = distanciaParentesco[0][celda], db = distanciaParentesco[1][celda];
+        if (da + db != r.distancia) continue;
+        agregarEntero(r.comunes, id);
+        agregarEntero(r.distanciasA, da);
+        agregarEntero(r.distanciasB, db);
+    }
+
+    liberarEnteros(vistos[0]);
+    liberarEnteros(vistos[1]);
+    liberarEnteros(encuentros);
+}
+
+// Sustantivo para la persona que est 'generaciones' por encima (o por
+// debajo) de la otra en lnea recta: padre/madre, abuelo/a, ...
+string gradoEnLinea(int generaciones, bool ascendente) {
+    static const char* arriba[] = {"", "padre/madre", "abuelo/a", "bisabuelo/a", "tatarabuelo/a"};
+    static const char* abajo[] = {"", "hijo/a", "nieto/a", "bisnieto/a", "tataranieto/a"};
+    if (generaciones <= 4) return ascendente ? arriba[generaciones] : abajo[generaciones];
+    ostringstream texto;
+    texto << (ascendente ? "ancestro/a" : "descendiente") << " a " << generaciones << " generaciones";
+    return texto.str();
+}
+
+// Nombre del parentesco de A respecto de B, dadas las generaciones de cada
+// uno al ancestro comn ms cercano. medio = true cuando se sabe que las dos
+// lneas bajan de ese ancestro por hijos de distinta pareja (medio hermano,
+// medio primo...).
+string nombrarParentesco(int da, int db, bool medio) {
+    if (da == 0 && db == 0) return "la misma persona";
+    if (da == 0) return gradoEnLinea(db, true);
+    if (db == 0) return gradoEnLinea(da, false);
+
+    string prefijo = medio ? "medio/a " : "";
+    if (da == 1 && db == 1) return prefijo + "hermano/a";
+    if (da == 1) {
+        // A es hermano/a de un ancestro de B.
+        if (db == 2) return prefijo + "tio/a";
+        return prefijo + "tio/a " + gradoEnLinea(db - 1, true);
     }
-    
-    if (persona->madre != NULL) {
-        for (int i = 0; i < nivel; i++) cout << "  ";
-        cout << "+- Madre: ";
-        mostrarAncestros(persona->madre, nivel + 1);
+    if (db == 1) {
+        if (da == 2) return prefijo + "sobrino/a";
+        return prefijo + "sobrino/a " + gradoEnLinea(da - 1, false);
+    }
+
+    static const char* ordinales[] = {"", "hermano/a", "segundo/a", "tercero/a", "cuarto/a", "quinto/a",
+                                      "sexto/a", "septimo/a", "octavo/a", "noveno/a"};
+    int grado = (da < db ? da : db) - 1;
+    int diferencia = (da > db) ? da - db : db - da;
+    ostringstream texto;
+    texto << prefijo << "primo/a ";
+    if (grado <= 9) texto << ordinales[grado];
+    else texto << "en grado " << grado;
+    if (diferencia == 1) texto << ", una generacion de diferencia";
+    else if (diferencia > 1) texto << ", " << diferencia << " generaciones de diferencia";
+    if (diferencia > 0) texto << (da < db ? " (generacion anterior)" : " (generacion posterior)");
+    return texto.str();
+}
+
+// Hijo de c por el que baja la lnea hasta p (p mismo si es hijo directo).
+// RETORNO: NULL si ningn hijo registrado de c es ancestro de p.
+Persona* hijoEnLinea(Persona* c, Persona* p) {
+    int n = cantidadHijos(c->id);
+    int* hijos = hijosDe(c->id);
+    for (int k = 0; k < n; k++) {
+        Persona* h = buscarPorID(hijos[k]);
+        if (h != NULL && esDescendiente(p, h)) return h;
+    }
+    return NULL;
+}
+
+Persona* otroProgenitor(Persona* h, Persona* c) {
+    return h->padre == c ? h->madre : h->padre;
+}
+
+// Describe el resultado: se nombra la relacin con el ancestro comn de
+// distancias ms parejas; si otro ancestro comparte esas mismas distancias
+// (los dos miembros de una pareja) el parentesco es completo. Con uno solo
+// es medio parentesco nicamente si las dos lneas bajan por hijos cuyo otro
+// progenitor est registrado y es distinto; si falta alguno no se sabe y no
+// se califica.
+string describirParentesco(Persona* a, Persona* b, Parentesco &r) {
+    if (r.comunes.cantidad == 0) return "sin parentesco de sangre registrado";
+    int elegido = 0;
+    for (int i = 1; i < r.comunes.cantidad; i++) {
+        int dif = abs(r.distanciasA.datos[i] - r.distanciasB.datos[i]);
+        if (dif < abs(r.distanciasA.datos[elegido] - r.distanciasB.datos[elegido])) elegido = i;
+    }
+    int da = r.distanciasA.datos[elegido], db = r.distanciasB.datos[elegido];
+    int iguales = 0;
+    for (int i = 0; i < r.comunes.cantidad; i++) {
+        if (r.distanciasA.datos[i] == da && r.distanciasB.datos[i] == db) iguales++;
+    }
+    bool medio = false;
+    if (iguales == 1 && da > 0 && db > 0) {
+        Persona* c = buscarPorID(r.comunes.datos[elegido]);
+        Persona* hijoA = hijoEnLinea(c, a);
+        Persona* hijoB = hijoEnLinea(c, b);
+        if (hijoA != NULL && hijoB != NULL && hijoA != hijoB) {
+            Persona* otroA = otroProgenitor(hijoA, c);
+            Persona* otroB = otroProgenitor(hijoB, c);
+            medio = otroA != NULL && otroB != NULL && otroA != otroB;
+        }
     }
+    return nombrarParentesco(da, db, medio);
+}
+
+void mostrarParentesco(Persona* a, Persona* b) {
+    Parentesco r;
+    inicializarParentesco(r);
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    calcularParentesco(a, b, r);
+    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - inicio).count();
+
+    cout << " " << a->nombre << " [" << a->id << "] es " << describirParentesco(a, b, r)
+         << " de " << b->nombre << " [" << b->id << "]\n";
+    if (r.comunes.cantidad > 0) {
+        cout << "\n Grado de consanguinidad (computo civil): " << r.distancia << "\n";
+        cout << " Ancestros comunes mas cercanos:\n";
+        for (int i = 0; i < r.comunes.cantidad; i++) {
+            cout << "  " << buscarPorID(r.comunes.datos[i])->nombre << " [" << r.comunes.datos[i] << "]: "
+                 << r.distanciasA.datos[i] << " generaciones desde " << a->nombre << ", "
+                 << r.distanciasB.datos[i] << " desde " << b->nombre << "\n";
+        }
+    }
+    cout << "\n (" << r.visitados << " ancestros explorados, " << fixed << setprecision(1) << us << " us)\n";
+    liberarParentesco(r);
 }
 
 // =============================================================================
-// FUNCIN: mostrarDescendientes
+// CONSANGUINIDAD (COEFICIENTE DE WRIGHT)
+// F(x) es el coeficiente de parentesco entre el padre y la madre de x. Se
+// calcula con el mtodo de Meuwissen y Luo: se recorre el cierre de
+// ancestros de la generacin ms alta a la ms baja, acumulando L(j) (la
+// fraccin de genes que llega desde j) y sumando L(j)^2 * d(j), donde d(j)
+// es la varianza mendeliana de j segn F de sus padres:
+//   1/2 - (F(padre) + F(madre))/4,  3/4 - F(progenitor)/4,  o 1 sin padres.
+// F(x) = suma - 1. Cada ancestro tiene una generacin menor que la de sus
+// descendientes (ver calcularGeneraciones), as que la cola por generacin
+// sustituye al orden topolgico y cada F ya calculada sirve de memo para
+// las siguientes. Las personas de una misma generacin son independientes:
+// se reparten en tramos entre hilos, cada uno con su propio L y su cola.
+// Dentro de una generacin se ordenan por padres y los hermanos completos
+// de un mismo tramo reutilizan la F ya calculada.
 // =============================================================================
-void mostrarDescendientes(Persona* persona) {
-    if (persona == NULL) return;
-    
-    cout << "Descendientes de " << persona->nombre << ":\n";
-    if (persona->izq != NULL) {
-        cout << "- " << persona->izq->nombre << endl;
-        mostrarDescendientes(persona->izq);
+const int TRAMO_CONSANGUINIDAD = 64;
+const int MINIMO_PARALELO = 256;        // Generaciones ms chicas van en un solo hilo
+
+struct TrabajoConsanguinidad {
+    double* L;                          // Por celda; 0 = no est en la cola
+    ListaEnteros* colas;                // Ancestros pendientes, por generacin
+    int limite;                         // Tamao de L
+    int generaciones;
+    long ancestros;                     // Ancestros recorridos (para medir)
+};
+
+struct CalculoConsanguinidad {
+    double* F;                          // Por celda; vlido si version == cambiosBase
+    int capacidad;
+    long version;
+    int hilos;
+    double segundos;
+    long ancestros;
+    TrabajoConsanguinidad consulta;     // Para parentescoWright fuera del clculo masivo
+};
+
+CalculoConsanguinidad consanguinidad = {NULL, 0, -1, 0, 0.0, 0, {NULL, NULL, 0, 0, 0}};
+
+void inicializarTrabajo(TrabajoConsanguinidad &t, int limite, int generaciones) {
+    t.L = new double[limite > 0 ? limite : 1];
+    for (int i = 0; i < limite; i++) t.L[i] = 0.0;
+    t.limite = limite;
+    t.colas = new ListaEnteros[generaciones];
+    for (int g = 0; g < generaciones; g++) inicializarEnteros(t.colas[g]);
+    t.generaciones = generaciones;
+    t.ancestros = 0;
+}
+
+void liberarTrabajo(TrabajoConsanguinidad &t) {
+    for (int g = 0; g < t.generaciones; g++) liberarEnteros(t.colas[g]);
+    delete[] t.colas;
+    delete[] t.L;
+    t.L = NULL;
+    t.colas = NULL;
+    t.limite = 0;
+    t.generaciones = 0;
+}
+
+double varianzaMendeliana(Persona* p, const double* F) {
+    if (p->padre != NULL && p->madre != NULL) return 0.5 - 0.25 * (F[p->padre->celda] + F[p->madre->celda]);
+    if (p->padre != NULL) return 0.75 - 0.25 * F[p->padre->celda];
+    if (p->madre != NULL) return 0.75 - 0.25 * F[p->madre->celda];
+    return 1.0;
+}
+
+// Suma l a L(p) y lo encola si no estaba. Una arista que no baja de
+// generacin (solo con ciclos en datos importados) se ignora.
+void aportarAncestro(TrabajoConsanguinidad &t, Persona* p, double l, int generacionHijo) {
+    if (p == NULL || p->generacion >= generacionHijo) return;
+    if (t.L[p->celda] == 0.0) agregarEntero(t.colas[p->generacion], p->id);
+    t.L[p->celda] += l;
+}
+
+// Coeficiente de parentesco entre a y b = F de un hijo hipottico de ambos.
+// Necesita F de todos los ancestros de a y b.
+double parentescoWright(TrabajoConsanguinidad &t, Persona* a, Persona* b, const double* F) {
+    if (a == NULL || b == NULL) return 0.0;
+    int tope = (a->generacion > b->generacion ? a->generacion : b->generacion) + 1;
+    double suma = 0.5 - 0.25 * (F[a->celda] + F[b->celda]);
+    aportarAncestro(t, a, 0.5, tope);
+    aportarAncestro(t, b, 0.5, tope);
+
+    for (int g = tope - 1; g >= 0; g--) {
+        ListaEnteros &cola = t.colas[g];
+        for (int i = 0; i < cola.cantidad; i++) {
+            Persona* j = buscarPorID(cola.datos[i]);
+            double l = t.L[j->celda];
+            t.L[j->celda] = 0.0;
+            suma += l * l * varianzaMendeliana(j, F);
+            // Con padre == madre (autofecundacin) el aporte llega dos veces.
+            aportarAncestro(t, j->padre, 0.5 * l, g);
+            aportarAncestro(t, j->madre, 0.5 * l, g);
+        }
+        t.ancestros += cola.cantidad;
+        cola.cantidad = 0;
+    }
+    return suma - 1.0;
+}
+
+int compararPorPadres(const void* a, const void* b) {
+    Persona* x = *(Persona* const*)a;
+    Persona* y = *(Persona* const*)b;
+    int px = x->padre != NULL ? x->padre->id : -1, py = y->padre != NULL ? y->padre->id : -1;
+    if (px != py) return (px > py) - (px < py);
+    int mx = x->madre != NULL ? x->madre->id : -1, my = y->madre != NULL ? y->madre->id : -1;
+    return (mx > my) - (mx < my);
+}
+
+// Calcula F para personas[inicio, fin) de una misma generacin.
+void consanguinidadTramo(TrabajoConsanguinidad &t, Persona** personas, long inicio, long fin, double* F) {
+    for (long k = inicio; k < fin; k++) {
+        Persona* p = personas[k];
+        if (k > inicio && personas[k - 1]->padre == p->padre && personas[k - 1]->madre == p->madre) {
+            F[p->celda] = F[personas[k - 1]->celda];
+        } else {
+            F[p->celda] = parentescoWright(t, p->padre, p->madre, F);
+        }
+    }
+}
+
+void hiloConsanguinidad(TrabajoConsanguinidad* t, Persona** personas, long inicio, long fin,
+                        atomic<long>* siguiente, double* F) {
+    while (true) {
+        long desde = inicio + siguiente->fetch_add(TRAMO_CONSANGUINIDAD);
+        if (desde >= fin) break;
+        long hasta = desde + TRAMO_CONSANGUINIDAD < fin ? desde + TRAMO_CONSANGUINIDAD : fin;
+        consanguinidadTramo(*t, personas, desde, hasta, F);
+    }
+}
+
+// Calcula F de toda la base con 'hilos' hilos (0 = todos los ncleos). El
+// resultado queda en consanguinidad.F hasta la prxima modificacin.
+void calcularConsanguinidad(int hilos) {
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    if (hilos <= 0) hilos = (int)thread::hardware_concurrency();
+    if (hilos <= 0) hilos = 1;
+
+    // Personas agrupadas por generacin (orden por conteo).
+    int maxGen = 0;
+    long n = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        n++;
+        if (p->generacion > maxGen) maxGen = p->generacion;
+    }
+    long* inicioGen = new long[maxGen + 2];
+    for (int g = 0; g <= maxGen + 1; g++) inicioGen[g] = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        if (tablaGlobal.personas[i] != NULL) inicioGen[tablaGlobal.personas[i]->generacion + 1]++;
+    }
+    for (int g = 1; g <= maxGen + 1; g++) inicioGen[g] += inicioGen[g - 1];
+    Persona** orden = new Persona*[n > 0 ? n : 1];
+    long* llenos = new long[maxGen + 1];
+    for (int g = 0; g <= maxGen; g++) llenos[g] = inicioGen[g];
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p != NULL) orden[llenos[p->generacion]++] = p;
+    }
+    delete[] llenos;
+
+    int limite = limiteCeldas();
+    if (limite > consanguinidad.capacidad) {
+        delete[] consanguinidad.F;
+        consanguinidad.F = new double[limite];
+        consanguinidad.capacidad = limite;
+    }
+    double* F = consanguinidad.F;
+
+    TrabajoConsanguinidad* trabajos = new TrabajoConsanguinidad[hilos];
+    for (int h = 0; h < hilos; h++) {
+        inicializarTrabajo(trabajos[h], limite, maxGen + 1);
+    }
+
+    thread* grupo = new thread[hilos];
+    for (int g = 0; g <= maxGen; g++) {
+        long desde = inicioGen[g], hasta = inicioGen[g + 1];
+        qsort(orden + desde, hasta - desde, sizeof(Persona*), compararPorPadres);
+        if (hilos == 1 || hasta - desde < MINIMO_PARALELO) {
+            consanguinidadTramo(trabajos[0], orden, desde, hasta, F);
+            continue;
+        }
+        atomic<long> siguiente(0);
+        for (int h = 0; h < hilos; h++) {
+            grupo[h] = thread(hiloConsanguinidad, &trabajos[h], orden, desde, hasta, &siguiente, F);
+        }
+        for (int h = 0; h < hilos; h++) {
+            grupo[h].join();
+        }
+    }
+    delete[] grupo;
+
+    consanguinidad.ancestros = 0;
+    for (int h = 0; h < hilos; h++) {
+        consanguinidad.ancestros += trabajos[h].ancestros;
+        liberarTrabajo(trabajos[h]);
+    }
+    delete[] trabajos;
+    delete[] orden;
+    delete[] inicioGen;
+
+    consanguinidad.version = cambiosBase;
+    consanguinidad.hilos = hilos;
+    consanguinidad.segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+}
+
+void asegurarConsanguinidad() {
+    if (consanguinidad.version != cambiosBase) calcularConsanguinidad(0);
+}
+
+// Parentesco de Wright entre dos personas (calcula antes F si hace falta).
+double coeficienteParentesco(Persona* a, Persona* b) {
+    asegurarConsanguinidad();
+    TrabajoConsanguinidad &t = consanguinidad.consulta;
+    int generaciones = (a->generacion > b->generacion ? a->generacion : b->generacion) + 1;
+    if (t.L == NULL || t.generaciones < generaciones || t.limite < limiteCeldas()) {
+        liberarTrabajo(t);
+        inicializarTrabajo(t, limiteCeldas(), generaciones);
+    }
+    return parentescoWright(t, a, b, consanguinidad.F);
+}
+
+void liberarConsanguinidad() {
+    delete[] consanguinidad.F;
+    liberarTrabajo(consanguinidad.consulta);
+    consanguinidad.F = NULL;
+    consanguinidad.capacidad = 0;
+    consanguinidad.version = -1;
+}
+
+// Escribe "id<TAB>F" de cada persona, en orden de ID; con prefijo, como
+// filas del modo por lotes. RETORNO: filas escritas.
+long escribirConsanguinidad(Salida &s, const char* prefijo) {
+    asegurarConsanguinidad();
+    if (prefijo == NULL) escribirTexto(s, "id\tF\n");
+    long filas = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        if (prefijo != NULL) {
+            escribirTexto(s, prefijo);
+            escribirCaracter(s, '\t');
+        }
+        escribirEntero(s, p->id);
+        escribirCaracter(s, '\t');
+        escribirDecimal(s, consanguinidad.F[p->celda], 6);
+        escribirCaracter(s, '\n');
+        filas++;
+    }
+    return filas;
+}
+
+// Escribe la tabla completa en un archivo. RETORNO: filas, o -1 si no se
+// pudo escribir.
+long guardarConsanguinidad(const char* ruta) {
+    FILE* f = fopen(ruta, "w");
+    if (f == NULL) return -1;
+    Salida s = {NULL, 0, f};
+    long filas = escribirConsanguinidad(s, NULL);
+    liberarSalida(s);
+    bool error = ferror(f) != 0;
+    if (fclose(f) != 0 || error) return -1;
+    return filas;
+}
+
+// Genera un pedigr sinttico profundo: 'generaciones' generaciones
+// repartidas en linajes de ANCHO_LINAJE personas. Cada hijo tiene un padre
+// del primer 10% de su linaje en la generacin anterior (pocos padres con
+// muchos hijos) y una madre del mismo linaje o, a veces, del vecino; as
+// hay mucha consanguinidad y el cierre de ancestros de cada persona queda
+// acotado, como en los pedigres reales.
+const int ANCHO_LINAJE = 50;
+
+void generarPedigriSintetico(Persona* &arbol, long personas, int generaciones) {
+    long ancho = personas / generaciones;
+    if (ancho < ANCHO_LINAJE) ancho = ANCHO_LINAJE;
+    ancho -= ancho % ANCHO_LINAJE;
+    Cadena nombre = guardarCadena("Sintetico");
+    unsigned int semilla = 12345;
+    long primeroAnterior = 0;
+    for (int g = 0; g < generaciones; g++) {
+        long primero = proximoID;
+        for (long k = 0; k < ancho; k++) {
+            Persona* padre = NULL;
+            Persona* madre = NULL;
+            if (g > 0) {
+                long linaje = k - k % ANCHO_LINAJE;
+                semilla = semilla * 1103515245u + 12345u;
+                padre = buscarPorID((int)(primeroAnterior + linaje + (semilla >> 8) % (ANCHO_LINAJE / 10)));
+                semilla = semilla * 1103515245u + 12345u;
+                if ((semilla >> 8) % 20 == 0) linaje = (linaje + ANCHO_LINAJE) % ancho;
+                semilla = semilla * 1103515245u + 12345u;
+                madre = buscarPorID((int)(primeroAnterior + linaje + (semilla >> 8) % ANCHO_LINAJE));
+            }
+            agregarPersona(arbol, proximoID++, nombre, FECHA_DESCONOCIDA, padre, madre);
+        }
+        primeroAnterior = primero;
+    }
+}
+
+// Mide el clculo completo con 1, 2, 4... hilos hasta los ncleos disponibles.
+void medirConsanguinidad(long personas, int generaciones) {
+    Persona* arbol = NULL;
+    generarPedigriSintetico(arbol, personas, generaciones);
+    int maxHilos = (int)thread::hardware_concurrency();
+    if (maxHilos <= 0) maxHilos = 1;
+
+    cout << "Consanguinidad de " << estadisticasAVL.nodos << " personas en " << generaciones
+         << " generaciones (" << maxHilos << " nucleos)\n\n";
+    cout << right << setw(6) << "hilos" << setw(12) << "segundos" << setw(12) << "aceleracion"
+         << setw(16) << "ancestros/s" << setw(12) << "F media" << "\n";
+    double base = 0;
+    for (int hilos = 1; ; hilos *= 2) {
+        if (hilos > maxHilos) hilos = maxHilos;
+        calcularConsanguinidad(hilos);
+        double suma = 0;
+        for (int i = 0; i < tablaGlobal.cantidad; i++) {
+            if (tablaGlobal.personas[i] != NULL) suma += consanguinidad.F[tablaGlobal.personas[i]->celda];
+        }
+        if (hilos == 1) base = consanguinidad.segundos;
+        cout << setw(6) << hilos << fixed << setprecision(3) << setw(12) << consanguinidad.segundos
+             << setprecision(2) << setw(12) << base / consanguinidad.segundos
+             << setprecision(0) << setw(16) << consanguinidad.ancestros / consanguinidad.segundos
+             << setprecision(6) << setw(12) << suma / estadisticasAVL.nodos << "\n";
+        if (hilos == maxHilos) break;
+    }
+    liberarConsanguinidad();
+    vaciarBase(arbol);
+}
+
+// =============================================================================
+// LECTURAS CONCURRENTES (VISTAS PUBLICADAS)
+// La base no es segura entre hilos: todas las modificaciones las hace un
+// nico escritor. Para consultar desde otros hilos el escritor publica una
+// vista inmutable (mismo formato de registros que la instantnea: ordenados
+// por ID, padre/madre como ndices, nombres copiados) y la cambia con un
+// solo intercambio atmico. Los lectores nunca esperan: anuncian la poca
+// en su ranura, toman la vista actual y la usan hasta salir. Una vista
+// reemplazada se libera recin cuando ningn lector activo anunci una
+// poca anterior a su retiro (reclamacin por pocas, como RCU).
+// =============================================================================
+const int MAX_LECTORES = 64;
+
+struct VistaLectura {
+    long version;                   // cambiosBase al publicarla
+    long cantidad;
+    RegistroInstantanea* registros; // Ordenados por ID
+    char* textos;
+    int limite;                     // Mayor ID + 1
+    unsigned long epocaRetiro;
+    VistaLectura* siguienteRetirada;
+};
+
+// Una lnea de cach por lector: alignas tambin la rellena hasta 64 bytes.
+struct alignas(64) RanuraLector {
+    atomic<unsigned long> epoca;    // poca anunciada + 1; 0 = fuera de lectura
+};
+
+// actual y epoca, que leen todos los lectores en cada entrada, van solos en
+// su lnea: ni las ranuras que escribe cada lector ni los campos del
+// escritor la invalidan.
+struct PublicacionVistas {
+    alignas(64) atomic<VistaLectura*> actual;
+    atomic<unsigned long> epoca;
+    RanuraLector ranuras[MAX_LECTORES];
+    alignas(64) atomic<int> lectores;   // Ranuras entregadas
+    mutex escritura;                // Serializa a los escritores
+    VistaLectura* retiradas;        // Esperando a que salgan sus lectores
+    long publicadas;
+    long liberadas;
+};
+
+PublicacionVistas vistas;
+
+// --- Lado lector -------------------------------------------------------------
+
+// RETORNO: ranura del lector, o -1 si no quedan.
+int registrarLector() {
+    int r = vistas.lectores.fetch_add(1);
+    return r < MAX_LECTORES ? r : -1;
+}
+
+// Vista vigente (NULL si no se public ninguna); sigue vlida hasta salirLectura.
+const VistaLectura* entrarLectura(int lector) {
+    vistas.ranuras[lector].epoca.store(vistas.epoca.load() + 1);
+    return vistas.actual.load();
+}
+
+void salirLectura(int lector) {
+    vistas.ranuras[lector].epoca.store(0);
+}
+
+// Primer registro con ID >= id; de ah en adelante, orden inorden.
+long vistaDesde(const VistaLectura* v, int id) {
+    long inicio = 0, fin = v->cantidad;
+    while (inicio < fin) {
+        long medio = (inicio + fin) / 2;
+        if (v->registros[medio].id < id) inicio = medio + 1;
+        else fin = medio;
+    }
+    return inicio;
+}
+
+const RegistroInstantanea* vistaBuscar(const VistaLectura* v, int id) {
+    if (v == NULL) return NULL;
+    long pos = vistaDesde(v, id);
+    if (pos == v->cantidad || v->registros[pos].id != id) return NULL;
+    return &v->registros[pos];
+}
+
+// Ancestros por niveles hasta 'generaciones' (0 = todos), como ndices de
+// registro. Cada lector usa sus propias listas y marcas.
+long vistaAncestros(const VistaLectura* v, long pos, int generaciones,
+                    ListaEnteros &indices, MarcasVisita &marcas) {
+    indices.cantidad = 0;
+    nuevaVisita(marcas, (int)v->cantidad);
+    marcarVisitado(marcas, (int)pos);
+    agregarEntero(indices, (int)pos);
+    long inicioNivel = 0;
+    for (int g = 0; generaciones == 0 || g < generaciones; g++) {
+        long finNivel = indices.cantidad;
+        if (inicioNivel == finNivel) break;
+        for (long i = inicioNivel; i < finNivel; i++) {
+            const RegistroInstantanea &r = v->registros[indices.datos[i]];
+            if (r.padre >= 0 && marcarVisitado(marcas, r.padre)) agregarEntero(indices, r.padre);
+            if (r.madre >= 0 && marcarVisitado(marcas, r.madre)) agregarEntero(indices, r.madre);
+        }
+        inicioNivel = finNivel;
+    }
+    return indices.cantidad - 1;
+}
+
+// --- Lado escritor -----------------------------------------------------------
+
+VistaLectura* construirVista() {
+    VistaLectura* v = new VistaLectura;
+    // ndice de registro de cada persona, por celda; solo hace falta para
+    // traducir padre/madre.
+    int* posicion = new int[limiteCeldas() > 0 ? limiteCeldas() : 1];
+    long cantidad = 0, bytesTexto = 0;
+    v->limite = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        posicion[p->celda] = (int)cantidad++;
+        bytesTexto += p->nombre.largo;
+        v->limite = p->id + 1;
+    }
+    v->cantidad = cantidad;
+    v->registros = new RegistroInstantanea[cantidad > 0 ? cantidad : 1];
+    v->textos = new char[bytesTexto > 0 ? bytesTexto : 1];
+
+    long k = 0, desplazamiento = 0;
+    for (int i = 0; i < tablaGlobal.cantidad; i++) {
+        Persona* p = tablaGlobal.personas[i];
+        if (p == NULL) continue;
+        RegistroInstantanea &r = v->registros[k++];
+        r.id = p->id;
+        r.fecha = p->fecha_nac.valor;
+        r.padre = p->padre != NULL ? posicion[p->padre->celda] : -1;
+        r.madre = p->madre != NULL ? posicion[p->madre->celda] : -1;
+        r.nombreInicio = desplazamiento;
+        r.nombreLargo = p->nombre.largo;
+        r.relleno = 0;
+        memcpy(v->textos + desplazamiento, p->nombre.datos, p->nombre.largo);
+        desplazamiento += p->nombre.largo;
+    }
+    delete[] posicion;
+    v->version = cambiosBase;
+    v->epocaRetiro = 0;
+    v->siguienteRetirada = NULL;
+    return v;
+}
+
+void destruirVista(VistaLectura* v) {
+    delete[] v->registros;
+    delete[] v->textos;
+    delete v;
+}
+
+// Libera las vistas retiradas que ya no puede estar usando ningn lector.
+void recolectarVistas() {
+    unsigned long minima = ~0UL;
+    int n = vistas.lectores.load();
+    if (n > MAX_LECTORES) n = MAX_LECTORES;
+    for (int i = 0; i < n; i++) {
+        unsigned long e = vistas.ranuras[i].epoca.load();
+        if (e != 0 && e - 1 < minima) minima = e - 1;
+    }
+    VistaLectura** enlace = &vistas.retiradas;
+    while (*enlace != NULL) {
+        VistaLectura* v = *enlace;
+        if (v->epocaRetiro <= minima) {
+            *enlace = v->siguienteRetirada;
+            destruirVista(v);
+            vistas.liberadas++;
+        } else {
+            enlace = &v->siguienteRetirada;
+        }
+    }
+}
+
+// Publica el estado actual de la base. Solo desde el hilo escritor. Un
+// lector que anunci la poca e < retiro pudo tomar la vista vieja; uno que
+// anunci retiro o ms ya ve la nueva.
+void publicarVista() {
+    lock_guard<mutex> cerrojo(vistas.escritura);
+    VistaLectura* nueva = construirVista();
+    VistaLectura* vieja = vistas.actual.exchange(nueva);
+    vistas.publicadas++;
+    if (vieja != NULL) {
+        vieja->epocaRetiro = vistas.epoca.fetch_add(1) + 1;
+        vieja->siguienteRetirada = vistas.retiradas;
+        vistas.retiradas = vieja;
+    }
+    recolectarVistas();
+}
+
+// Al terminar, sin lectores activos.
+void liberarVistas() {
+    lock_guard<mutex> cerrojo(vistas.escritura);
+    VistaLectura* v = vistas.actual.exchange(NULL);
+    if (v != NULL) destruirVista(v);
+    while (vistas.retiradas != NULL) {
+        VistaLectura* sig = vistas.retiradas->siguienteRetirada;
+        destruirVista(vistas.retiradas);
+        vistas.retiradas = sig;
+    }
+    vistas.lectores.store(0);
+}
+
+// --- Medicin ----------------------------------------------------------------
+
+struct MedicionLector {
+    atomic<bool>* parar;
+    long operaciones;
+    long encontrados;
+};
+
+// Mezcla de consultas: 60% bsqueda por ID, 30% ancestros (4 generaciones),
+// 10% recorrido inorden de 64 personas. Cada consulta es una lectura.
+void hiloLector(MedicionLector* m, unsigned int semilla) {
+    int lector = registrarLector();
+    if (lector < 0) return;
+    ListaEnteros indices;
+    inicializarEnteros(indices);
+    MarcasVisita marcas;
+    inicializarMarcas(marcas);
+    long operaciones = 0, encontrados = 0;
+    while (!m->parar->load(memory_order_relaxed)) {
+        semilla ^= semilla << 13;
+        semilla ^= semilla >> 17;
+        semilla ^= semilla << 5;
+        const VistaLectura* v = entrarLectura(lector);
+        if (v != NULL && v->cantidad > 0) {
+            int id = (int)(semilla % (unsigned int)v->limite);
+            unsigned int tipo = (semilla >> 24) % 10;
+            if (tipo < 6) {
+                if (vistaBuscar(v, id) != NULL) encontrados++;
+            } else if (tipo < 9) {
+                long pos = vistaDesde(v, id);
+                if (pos < v->cantidad) encontrados += vistaAncestros(v, pos, 4, indices, marcas);
+            } else {
+                for (long pos = vistaDesde(v, id), k = 0; pos < v->cantidad && k < 64; pos++, k++) {
+                    encontrados += v->registros[pos].nombreLargo > 0;
+                }
+            }
+        }
+        salirLectura(lector);
+        operaciones++;
+    }
+    liberarEnteros(indices);
+    liberarMarcas(marcas);
+    m->operaciones = operaciones;
+    m->encontrados = encontrados;
+}
+
+// Escritor: altas continuas con padres al azar y una publicacin cada
+// 'intervaloMs'.
+void hiloEscritor(Persona** arbol, atomic<bool>* parar, int intervaloMs, long* altas) {
+    Cadena nombre = guardarCadena("Escritor");
+    unsigned int semilla = 777;
+    chrono::steady_clock::time_point ultima = chrono::steady_clock::now();
+    while (!parar->load(memory_order_relaxed)) {
+        semilla = semilla * 1103515245u + 12345u;
+        Persona* padre = buscarPorID((int)((semilla >> 8) % (unsigned int)proximoID));
+        agregarPersona(*arbol, proximoID++, nombre, FECHA_DESCONOCIDA, padre, NULL);
+        (*altas)++;
+        if (chrono::steady_clock::now() - ultima >= chrono::milliseconds(intervaloMs)) {
+            publicarVista();
+            ultima = chrono::steady_clock::now();
+        }
+    }
+}
+
+// Lecturas por segundo con 1, 2, 4... lectores hasta los ncleos
+// disponibles, con el escritor dando altas y publicando a la vez.
+void medirLectores(long personas) {
+    Persona* arbol = NULL;
+    generarPedigriSintetico(arbol, personas, 50);
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    publicarVista();
+    double msPublicar = chrono::duration<double>(chrono::steady_clock::now() - inicio).count() * 1000;
+
+    int maxHilos = (int)thread::hardware_concurrency();
+    if (maxHilos <= 0) maxHilos = 1;
+    if (maxHilos > MAX_LECTORES / 2) maxHilos = MAX_LECTORES / 2;
+    const int intervaloMs = 100;
+
+    cout << "Lectores concurrentes sobre " << estadisticasAVL.nodos << " personas (" << maxHilos
+         << " nucleos, publicar: " << fixed << setprecision(1) << msPublicar << " ms, cada "
+         << intervaloMs << " ms)\n\n";
+    cout << right << setw(8) << "lectores" << setw(16) << "lecturas/s" << setw(12) << "aceleracion"
+         << setw(12) << "altas/s" << setw(12) << "publicadas" << setw(12) << "liberadas" << "\n";
+    double base = 0;
+    for (int hilos = 1; ; hilos *= 2) {
+        if (hilos > maxHilos) hilos = maxHilos;
+        atomic<bool> parar(false);
+        MedicionLector* m = new MedicionLector[hilos];
+        thread* lectores = new thread[hilos];
+        long altas = 0, publicadasAntes = vistas.publicadas, liberadasAntes = vistas.liberadas;
+        vistas.lectores.store(0);
+
+        inicio = chrono::steady_clock::now();
+        for (int h = 0; h < hilos; h++) {
+            m[h].parar = &parar;
+            m[h].operaciones = 0;
+            m[h].encontrados = 0;
+            lectores[h] = thread(hiloLector, &m[h], 2463534242u + 97u * h);
+        }
+        thread escritor(hiloEscritor, &arbol, &parar, intervaloMs, &altas);
+        this_thread::sleep_for(chrono::seconds(1));
+        parar.store(true);
+        for (int h = 0; h < hilos; h++) lectores[h].join();
+        escritor.join();
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+        long total = 0;
+        for (int h = 0; h < hilos; h++) total += m[h].operaciones;
+        double porSegundo = total / segundos;
+        if (hilos == 1) base = porSegundo;
+        cout << setw(8) << hilos << setprecision(0) << setw(16) << porSegundo
+             << setprecision(2) << setw(12) << porSegundo / base
+             << setprecision(0) << setw(12) << altas / segundos
+             << setw(12) << vistas.publicadas - publicadasAntes
+             << setw(12) << vistas.liberadas - liberadasAntes << "\n";
+        delete[] lectores;
+        delete[] m;
+        if (hilos == maxHilos) break;
+    }
+    liberarVistas();
+    vaciarBase(arbol);
+}
+
+// =============================================================================
+// REDUCCIN PARALELA CON ROBO DE TRABAJO
+// Recorre la tabla de personas (contigua y ordenada por ID) en paralelo y
+// reduce con acumuladores por hilo, que al final se combinan en uno. Cada
+// obrero tiene una cola de tramos: toma del fondo y, mientras su tramo sea
+// ms grande que GRANO_REDUCCION, deja la mitad superior en la cola y sigue
+// con la inferior. Un obrero sin trabajo le roba a otro el tramo ms viejo
+// (el ms grande) de la cima. Los obreros viven en una piscina fija que se
+// despierta para cada reduccin; el hilo que llama trabaja como obrero 0.
+// =============================================================================
+const long GRANO_REDUCCION = 4096;
+const int MAX_TRAMOS_COLA = 64;         // La divisin binaria no pasa de log2(n / grano)
+
+struct Reduccion {
+    size_t tamano;                              // Bytes de un acumulador
+    void (*iniciar)(void* acumulador);
+    void (*acumular)(void* acumulador, Persona* p);
+    void (*combinar)(void* destino, void* origen);
+    void (*liberar)(void* acumulador);          // Puede ser NULL
+};
+
+struct TramoReduccion {
+    long desde;
+    long hasta;
+};
+
+struct ColaTramos {
+    mutex cerrojo;
+    TramoReduccion tramos[MAX_TRAMOS_COLA];
+    int cima;                           // Prximo a robar
+    int fondo;                          // Uno despus del ltimo propio
+    long robados;
+};
+
+struct PiscinaHilos {
+    int hilos;                          // Obreros, contando al que llama
+    thread* obreros;
+    ColaTramos* colas;
+    mutex cerrojo;
+    condition_variable aviso;           // Hay tarea nueva o hay que cerrar
+    condition_variable listo;           // Un obrero termin la tarea
+    long tarea;
+    int terminados;
+    bool cerrar;
+    // Tarea vigente
+    const Reduccion* reduccion;
+    char* acumuladores;
+    size_t paso;                        // Un acumulador por lnea de cach
+    atomic<long> pendientes;            // Posiciones de la tabla sin procesar
+};
+
+PiscinaHilos piscina;
+
+bool tomarTramoPropio(ColaTramos &c, TramoReduccion &t) {
+    lock_guard<mutex> cerrojo(c.cerrojo);
+    if (c.fondo == c.cima) return false;
+    t = c.tramos[--c.fondo];
+    if (c.fondo == c.cima) c.fondo = c.cima = 0;
+    return true;
+}
+
+void dejarTramo(ColaTramos &c, TramoReduccion t) {
+    lock_guard<mutex> cerrojo(c.cerrojo);
+    c.tramos[c.fondo++] = t;
+}
+
+bool robarTramo(int obrero, TramoReduccion &t) {
+    for (int k = 1; k < piscina.hilos; k++) {
+        ColaTramos &c = piscina.colas[(obrero + k) % piscina.hilos];
+        lock_guard<mutex> cerrojo(c.cerrojo);
+        if (c.fondo == c.cima) continue;
+        t = c.tramos[c.cima++];
+        if (c.fondo == c.cima) c.fondo = c.cima = 0;
+        piscina.colas[obrero].robados++;
+        return true;
+    }
+    return false;
+}
+
+void trabajarEnReduccion(int obrero) {
+    ColaTramos &mia = piscina.colas[obrero];
+    void* acumulador = piscina.acumuladores + obrero * piscina.paso;
+    void (*acumular)(void*, Persona*) = piscina.reduccion->acumular;
+    Persona** personas = tablaGlobal.personas;
+    while (piscina.pendientes.load() > 0) {
+        TramoReduccion t;
+        if (!tomarTramoPropio(mia, t) && !robarTramo(obrero, t)) {
+            this_thread::yield();
+            continue;
+        }
+        while (t.hasta - t.desde > GRANO_REDUCCION) {
+            TramoReduccion mitad = {t.desde + (t.hasta - t.desde) / 2, t.hasta};
+            dejarTramo(mia, mitad);
+            t.hasta = mitad.desde;
+        }
+        for (long i = t.desde; i < t.hasta; i++) {
+            if (personas[i] != NULL) acumular(acumulador, personas[i]);
+        }
+        piscina.pendientes.fetch_sub(t.hasta - t.desde);
+    }
+}
+
+// 'vista' es la ltima tarea que hubo antes de crear al obrero: una piscina
+// reabierta con otra cantidad de hilos no debe repetir una tarea vieja.
+void bucleObrero(int obrero, long vista) {
+    while (true) {
+        {
+            unique_lock<mutex> cerrojo(piscina.cerrojo);
+            piscina.aviso.wait(cerrojo, [&] { return piscina.cerrar || piscina.tarea != vista; });
+            if (piscina.cerrar) return;
+            vista = piscina.tarea;
+        }
+        trabajarEnReduccion(obrero);
+        lock_guard<mutex> cerrojo(piscina.cerrojo);
+        piscina.terminados++;
+        piscina.listo.notify_one();
+    }
+}
+
+void cerrarPiscina() {
+    if (piscina.hilos == 0) return;
+    {
+        lock_guard<mutex> cerrojo(piscina.cerrojo);
+        piscina.cerrar = true;
+    }
+    piscina.aviso.notify_all();
+    for (int h = 1; h < piscina.hilos; h++) piscina.obreros[h].join();
+    delete[] piscina.obreros;
+    delete[] piscina.colas;
+    piscina.obreros = NULL;
+    piscina.colas = NULL;
+    piscina.hilos = 0;
+    piscina.cerrar = false;
+}
+
+void abrirPiscina(int hilos) {
+    if (piscina.hilos == hilos) return;
+    cerrarPiscina();
+    piscina.hilos = hilos;
+    piscina.colas = new ColaTramos[hilos];
+    for (int h = 0; h < hilos; h++) {
+        piscina.colas[h].cima = piscina.colas[h].fondo = 0;
+        piscina.colas[h].robados = 0;
+    }
+    piscina.obreros = new thread[hilos];
+    for (int h = 1; h < hilos; h++) piscina.obreros[h] = thread(bucleObrero, h, piscina.tarea);
+}
+
+// Reduce toda la base con 'hilos' obreros (0 = todos los ncleos). resultado
+// queda iniciado y con todo combinado; liberarlo es cosa de quien llama.
+// RETORNO: tramos robados (mide cunto se redistribuy el trabajo).
+long reducirPersonas(const Reduccion &r, void* resultado, int hilos) {
+    if (hilos <= 0) hilos = (int)thread::hardware_concurrency();
+    if (hilos <= 0) hilos = 1;
+    abrirPiscina(hilos);
+
+    piscina.paso = (r.tamano + 63) / 64 * 64;
+    piscina.acumuladores = new char[piscina.paso * hilos];
+    for (int h = 0; h < hilos; h++) r.iniciar(piscina.acumuladores + h * piscina.paso);
+    piscina.reduccion = &r;
+    long robadosAntes = 0;
+    for (int h = 0; h < hilos; h++) robadosAntes += piscina.colas[h].robados;
+
+    TramoReduccion todo = {0, tablaGlobal.cantidad};
+    piscina.pendientes.store(todo.hasta);
+    if (todo.hasta > 0) dejarTramo(piscina.colas[0], todo);
+    {
+        lock_guard<mutex> cerrojo(piscina.cerrojo);
+        piscina.terminados = 0;
+        piscina.tarea++;
+    }
+    piscina.aviso.notify_all();
+    trabajarEnReduccion(0);
+    {
+        unique_lock<mutex> cerrojo(piscina.cerrojo);
+        piscina.listo.wait(cerrojo, [&] { return piscina.terminados == hilos - 1; });
+    }
+
+    r.iniciar(resultado);
+    long robados = -robadosAntes;
+    for (int h = 0; h < hilos; h++) {
+        void* a = piscina.acumuladores + h * piscina.paso;
+        r.combinar(resultado, a);
+        if (r.liberar != NULL) r.liberar(a);
+        robados += piscina.colas[h].robados;
+    }
+    delete[] piscina.acumuladores;
+    piscina.acumuladores = NULL;
+    return robados;
+}
+
+// --- Informe de poblacin ----------------------------------------------------
+// Nacimientos por dcada, frecuencia de nombres de pila (primera palabra, tal
+// como est escrita) y personas sin padre, sin madre o sin ninguno.
+
+const int NUM_DECADAS = 1000;           // Aos 0 a 9999; los posteriores van a la ltima
+
+struct EntradaFrecuencia {
+    const char* texto;                  // En el montculo de cadenas; NULL = libre
+    int largo;
+    long cantidad;
+};
+
+struct TablaFrecuencias {
+    EntradaFrecuencia* entradas;
+    int capacidad;                      // Potencia de 2
+    int usadas;
+};
+
+struct InformePoblacion {
+    long personas;
+    long sinFecha;
+    long porDecada[NUM_DECADAS];
+    long sinPadre;
+    long sinMadre;
+    long sinNinguno;
+    TablaFrecuencias nombres;
+};
+
+unsigned int hashTexto(const char* texto, int largo) {
+    unsigned int h = 2166136261u;
+    for (int i = 0; i < largo; i++) {
+        h = (h ^ (unsigned char)texto[i]) * 16777619u;
+    }
+    return h;
+}
+
+void sumarFrecuencia(TablaFrecuencias &t, const char* texto, int largo, long cantidad) {
+    if ((t.usadas + 1) * 10 > t.capacidad * 7) {
+        int nuevaCap = t.capacidad == 0 ? 256 : t.capacidad * 2;
+        EntradaFrecuencia* nuevas = new EntradaFrecuencia[nuevaCap];
+        for (int i = 0; i < nuevaCap; i++) nuevas[i].texto = NULL;
+        for (int i = 0; i < t.capacidad; i++) {
+            EntradaFrecuencia &e = t.entradas[i];
+            if (e.texto == NULL) continue;
+            unsigned int k = hashTexto(e.texto, e.largo) & (nuevaCap - 1);
+            while (nuevas[k].texto != NULL) k = (k + 1) & (nuevaCap - 1);
+            nuevas[k] = e;
+        }
+        delete[] t.entradas;
+        t.entradas = nuevas;
+        t.capacidad = nuevaCap;
+    }
+    unsigned int k = hashTexto(texto, largo) & (t.capacidad - 1);
+    while (t.entradas[k].texto != NULL) {
+        EntradaFrecuencia &e = t.entradas[k];
+        if (e.largo == largo && memcmp(e.texto, texto, largo) == 0) {
+            e.cantidad += cantidad;
+            return;
+        }
+        k = (k + 1) & (t.capacidad - 1);
+    }
+    t.entradas[k].texto = texto;
+    t.entradas[k].largo = largo;
+    t.entradas[k].cantidad = cantidad;
+    t.usadas++;
+}
+
+void iniciarInforme(void* a) {
+    InformePoblacion* inf = (InformePoblacion*)a;
+    memset(inf, 0, sizeof(InformePoblacion));
+}
+
+void acumularInforme(void* a, Persona* p) {
+    InformePoblacion* inf = (InformePoblacion*)a;
+    inf->personas++;
+    if (p->fecha_nac == FECHA_DESCONOCIDA) {
+        inf->sinFecha++;
+    } else {
+        int decada = anioDe(p->fecha_nac) / 10;
+        inf->porDecada[decada < NUM_DECADAS ? decada : NUM_DECADAS - 1]++;
+    }
+    if (p->padre == NULL) inf->sinPadre++;
+    if (p->madre == NULL) inf->sinMadre++;
+    if (p->padre == NULL && p->madre == NULL) inf->sinNinguno++;
+    int largo = 0;
+    while (largo < p->nombre.largo && p->nombre.datos[largo] != ' ') largo++;
+    if (largo > 0) sumarFrecuencia(inf->nombres, p->nombre.datos, largo, 1);
+}
+
+void combinarInforme(void* d, void* o) {
+    InformePoblacion* destino = (InformePoblacion*)d;
+    InformePoblacion* origen = (InformePoblacion*)o;
+    destino->personas += origen->personas;
+    destino->sinFecha += origen->sinFecha;
+    for (int i = 0; i < NUM_DECADAS; i++) destino->porDecada[i] += origen->porDecada[i];
+    destino->sinPadre += origen->sinPadre;
+    destino->sinMadre += origen->sinMadre;
+    destino->sinNinguno += origen->sinNinguno;
+    for (int i = 0; i < origen->nombres.capacidad; i++) {
+        EntradaFrecuencia &e = origen->nombres.entradas[i];
+        if (e.texto != NULL) sumarFrecuencia(destino->nombres, e.texto, e.largo, e.cantidad);
+    }
+}
+
+void liberarInforme(void* a) {
+    InformePoblacion* inf = (InformePoblacion*)a;
+    delete[] inf->nombres.entradas;
+    inf->nombres.entradas = NULL;
+    inf->nombres.capacidad = inf->nombres.usadas = 0;
+}
+
+const Reduccion REDUCCION_INFORME = {
+    sizeof(InformePoblacion), iniciarInforme, acumularInforme, combinarInforme, liberarInforme
+};
+
+int compararFrecuencias(const void* a, const void* b) {
+    const EntradaFrecuencia* x = (const EntradaFrecuencia*)a;
+    const EntradaFrecuencia* y = (const EntradaFrecuencia*)b;
+    if (x->cantidad != y->cantidad) return x->cantidad > y->cantidad ? -1 : 1;
+    int c = memcmp(x->texto, y->texto, x->largo < y->largo ? x->largo : y->largo);
+    return c != 0 ? c : x->largo - y->largo;
+}
+
+// Los 'cantidad' nombres ms frecuentes, de mayor a menor (empates en orden
+// alfabtico). RETORNO: arreglo nuevo con *n entradas.
+EntradaFrecuencia* nombresMasFrecuentes(const InformePoblacion &inf, int cantidad, int* n) {
+    EntradaFrecuencia* todas = new EntradaFrecuencia[inf.nombres.usadas > 0 ? inf.nombres.usadas : 1];
+    int k = 0;
+    for (int i = 0; i < inf.nombres.capacidad; i++) {
+        if (inf.nombres.entradas[i].texto != NULL) todas[k++] = inf.nombres.entradas[i];
+    }
+    qsort(todas, k, sizeof(EntradaFrecuencia), compararFrecuencias);
+    *n = k < cantidad ? k : cantidad;
+    return todas;
+}
+
+// Poblacin sinttica por la importacin masiva: nombres combinados de dos
+// listas, fechas repartidas entre 1500 y 2019 y padres de la generacin
+// anterior (alrededor de un 5% sin padre o sin madre).
+void generarPoblacionSintetica(Persona* &arbol, long personas) {
+    static const char* nombres[] = {"Juan", "Maria", "Jose", "Ana", "Luis", "Carmen", "Pedro", "Rosa",
+                                    "Carlos", "Lucia", "Jorge", "Elena", "Miguel", "Sofia", "Diego", "Laura"};
+    static const char* apellidos[] = {"Garcia", "Lopez", "Perez", "Gonzalez", "Rodriguez", "Fernandez",
+                                      "Martinez", "Sanchez", "Romero", "Diaz", "Torres", "Ruiz"};
+    const long ancho = personas / 40 > 1 ? personas / 40 : 1;
+    LoteImportacion lote;
+    inicializarLote(lote);
+    unsigned int semilla = 4242;
+    char texto[64];
+    for (long i = 0; i < personas; i++) {
+        RegistroImportado* r = nuevoRegistro(lote);
+        r->id = (int)(i + 1);
+        long generacion = i / ancho;
+        semilla = semilla * 1103515245u + 12345u;
+        int largo = snprintf(texto, sizeof(texto), "%s %s", nombres[(semilla >> 8) % 16],
+                             apellidos[(semilla >> 16) % 12]);
+        guardarNombre(lote, r, texto, largo);
+        semilla = semilla * 1103515245u + 12345u;
+        if ((semilla >> 8) % 50 != 0) {
+            r->fecha = empaquetarFecha(1 + (semilla >> 12) % 28, 1 + (semilla >> 20) % 12,
+                                       (int)(1500 + generacion * 13 + (semilla >> 24) % 13));
+        }
+        if (generacion > 0) {
+            long base = (generacion - 1) * ancho + 1;
+            semilla = semilla * 1103515245u + 12345u;
+            if ((semilla >> 8) % 20 != 0) r->idPadre = (int)(base + (semilla >> 10) % ancho);
+            semilla = semilla * 1103515245u + 12345u;
+            if ((semilla >> 8) % 20 != 0) r->idMadre = (int)(base + (semilla >> 10) % ancho);
+        }
     }
-    if (persona->der != NULL) {
-        cout << "- " << persona->der->nombre << endl;
-        mostrarDescendientes(persona->der);
+    ResultadoImportacion res;
+    memset(&res, 0, sizeof(res));
+    cargarLote(arbol, lote, res);
+    liberarLote(lote);
+}
+
+// Informe completo con 1, 2, 4... obreros hasta los ncleos disponibles.
+// La suma de control (dcadas ponderadas, faltantes y nombres) tiene que
+// dar igual con cualquier cantidad de hilos.
+void medirReduccion(long personas) {
+    Persona* arbol = NULL;
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    generarPoblacionSintetica(arbol, personas);
+    double segundosCarga = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    int maxHilos = (int)thread::hardware_concurrency();
+    if (maxHilos <= 0) maxHilos = 1;
+    cout << "Informe de poblacion sobre " << estadisticasAVL.nodos << " personas (" << maxHilos
+         << " nucleos, carga " << fixed << setprecision(1) << segundosCarga << " s)\n\n";
+    cout << right << setw(6) << "hilos" << setw(12) << "segundos" << setw(12) << "aceleracion"
+         << setw(16) << "personas/s" << setw(10) << "robos" << setw(20) << "control" << "\n";
+    double base = 0;
+    for (int hilos = 1; ; hilos *= 2) {
+        if (hilos > maxHilos) hilos = maxHilos;
+        InformePoblacion* inf = new InformePoblacion;
+        inicio = chrono::steady_clock::now();
+        long robos = reducirPersonas(REDUCCION_INFORME, inf, hilos);
+        double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+        long long control = inf->sinFecha + 3LL * inf->sinPadre + 5LL * inf->sinMadre + 7LL * inf->sinNinguno;
+        for (int i = 0; i < NUM_DECADAS; i++) control += (long long)(i + 1) * inf->porDecada[i];
+        for (int i = 0; i < inf->nombres.capacidad; i++) {
+            EntradaFrecuencia &e = inf->nombres.entradas[i];
+            if (e.texto != NULL) control += (long long)hashTexto(e.texto, e.largo) % 1000 * e.cantidad;
+        }
+        if (hilos == 1) base = segundos;
+        cout << setw(6) << hilos << setprecision(3) << setw(12) << segundos
+             << setprecision(2) << setw(12) << base / segundos
+             << setprecision(0) << setw(16) << inf->personas / segundos
+             << setw(10) << robos << setw(20) << control << "\n";
+        liberarInforme(inf);
+        delete inf;
+        if (hilos == maxHilos) break;
     }
+    cerrarPiscina();
+    vaciarBase(arbol);
 }
 
 // =============================================================================
 // RECORRIDOS DEL RBOL
 // =============================================================================
 
+void listarRecorrido(Persona* raiz, void (*recorrer)(Persona*, VisitaPersona), long desde, long limite) {
+    cout.flush();
+    comenzarListado(salidaEstandar, LISTADO_LINEA, desde, limite);
+    listarConRecorrido(raiz, recorrer);
+    terminarListado();
+}
+
 // PREORDEN: Raz - Izquierda - Derecha
-void preorden(Persona* raiz) {
-    if (raiz == NULL) return;
-    cout << "[" << raiz->id << "] " << raiz->nombre << " (" << raiz->fecha_nac << ")\n";
-    preorden(raiz->izq);
-    preorden(raiz->der);
+void preorden(Persona* raiz, long desde = 0, long limite = 0) {
+    listarRecorrido(raiz, recorrerPreorden, desde, limite);
 }
 
 // INORDEN: Izquierda - Raz - Derecha
-void inorden(Persona* raiz) {
-    if (raiz == NULL) return;
-    inorden(raiz->izq);
-    cout << "[" << raiz->id << "] " << raiz->nombre << " (" << raiz->fecha_nac << ")\n";
-    inorden(raiz->der);
+void inorden(Persona* raiz, long desde = 0, long limite = 0) {
+    listarRecorrido(raiz, recorrerInorden, desde, limite);
+}
+
+// INORDEN SIN PILA (Morris)
+void inordenMorris(Persona* raiz, long desde = 0, long limite = 0) {
+    listarRecorrido(raiz, recorrerInordenMorris, desde, limite);
 }
 
 // POSTORDEN: Izquierda - Derecha - Raz
-void postorden(Persona* raiz) {
-    if (raiz == NULL) return;
-    postorden(raiz->izq);
-    postorden(raiz->der);
-    cout << "[" << raiz->id << "] " << raiz->nombre << " (" << raiz->fecha_nac << ")\n";
+void postorden(Persona* raiz, long desde = 0, long limite = 0) {
+    listarRecorrido(raiz, recorrerPostorden, desde, limite);
 }
 
 // =============================================================================
 // ESTRUCTURA: Cola para recorrido por niveles
+// Cola circular que duplica su capacidad al llenarse: encolar y desencolar
+// son O(1) amortizado y no hay lmite de nodos.
 // =============================================================================
 struct Cola {
-    Persona* elementos[100];
-    int frente;
-    int final;
+    Persona** elementos;
+    int capacidad;      // Siempre potencia de 2
+    int frente;         // Posicin del primer elemento
+    int cantidad;
 };
 
 void inicializarCola(Cola &c) {
+    c.capacidad = 64;
+    c.elementos = new Persona*[c.capacidad];
     c.frente = 0;
-    c.final = -1;
+    c.cantidad = 0;
+}
+
+void liberarCola(Cola &c) {
+    delete[] c.elementos;
+    c.elementos = NULL;
+    c.capacidad = 0;
+    c.cantidad = 0;
 }
 
 void encolar(Cola &c, Persona* p) {
-    if (c.final < 99) {
-        c.elementos[++c.final] = p;
+    if (c.cantidad == c.capacidad) {
+        Persona** nuevos = new Persona*[c.capacidad * 2];
+        for (int i = 0; i < c.cantidad; i++) {
+            nuevos[i] = c.elementos[(c.frente + i) & (c.capacidad - 1)];
+        }
+        delete[] c.elementos;
+        c.elementos = nuevos;
+        c.capacidad *= 2;
+        c.frente = 0;
     }
+    c.elementos[(c.frente + c.cantidad) & (c.capacidad - 1)] = p;
+    c.cantidad++;
 }
 
 Persona* frente(Cola &c) {
-    if (c.frente > c.final) return NULL;
+    if (c.cantidad == 0) return NULL;
     return c.elementos[c.frente];
 }
 
 void desencolar(Cola &c) {
-    if (c.frente <= c.final) {
-        c.frente++;
+    if (c.cantidad > 0) {
+        c.frente = (c.frente + 1) & (c.capacidad - 1);
+        c.cantidad--;
     }
 }
 
 bool colaVacia(Cola &c) {
-    return c.frente > c.final;
+    return c.cantidad == 0;
 }
 
 // RECORRIDO POR NIVELES (BFS)
-void porNiveles(Persona* raiz) {
+// Cada nivel termina cuando se imprimieron tantos nodos como se encolaron
+// desde el nivel anterior; no se supone un rbol completo.
+void porNiveles(Persona* raiz, long desde = 0, long limite = 0) {
     if (raiz == NULL) return;
     
+    cout.flush();
+    comenzarListado(salidaEstandar, LISTADO_LINEA, desde, limite);
+    Salida &s = salidaEstandar;
+    bool nivelConFilas = false;
+    
     Cola c;
     inicializarCola(c);
     encolar(c, raiz);
     
-    int nivelActual = 0;
     int nodosNivel = 1;
-    int nodosContados = 0;
+    int nodosSiguiente = 0;
     
-    while (!colaVacia(c)) {
+    while (!colaVacia(c) && !listadoCompleto()) {
         Persona* actual = frente(c);
         desencolar(c);
         
-        cout << "[" << actual->id << "] " << actual->nombre << " (" << actual->fecha_nac << ")  ";
-        nodosContados++;
+        if (filaEnPagina()) {
+            escribirFilaLinea(s, actual);
+            escribirTexto(s, "  ");
+            listado.emitidas++;
+            nivelConFilas = true;
+        }
+        
+        if (actual->izq != NULL) { encolar(c, actual->izq); nodosSiguiente++; }
+        if (actual->der != NULL) { encolar(c, actual->der); nodosSiguiente++; }
         
+        if (--nodosNivel == 0) {
+            if (nivelConFilas) escribirCaracter(s, '\n');
+            nivelConFilas = false;
+            nodosNivel = nodosSiguiente;
+            nodosSiguiente = 0;
+        }
+    }
+    liberarCola(c);
+    terminarListado();
+}
+
+void recorrerPorNiveles(Persona* raiz, VisitaPersona visita) {
+    if (raiz == NULL) return;
+    
+    Cola c;
+    inicializarCola(c);
+    encolar(c, raiz);
+    while (!colaVacia(c)) {
+        Persona* actual = frente(c);
+        desencolar(c);
+        if (!visita(actual)) break;
         if (actual->izq != NULL) encolar(c, actual->izq);
         if (actual->der != NULL) encolar(c, actual->der);
+    }
+    liberarCola(c);
+}
+
+// =============================================================================
+// MODO POR LOTES
+// Lee comandos de un archivo (o de la entrada estndar con "-") y responde
+// en texto separado por tabuladores, sin limpiar la pantalla ni esperar
+// ENTER. Cada comando termina con una sola lnea de estado:
+//   ok<TAB>comando<TAB>dato           (ID creado/borrado o filas emitidas)
+//   error<TAB>comando<TAB>lnea<TAB>mensaje
+// precedida por sus filas de datos, si las tiene:
+//   persona<TAB>id<TAB>nombre<TAB>fecha<TAB>padre<TAB>madre   ("-" = sin dato)
+//   ancestro<TAB>id<TAB>nombre<TAB>generacin
+//   descendiente<TAB>id<TAB>nombre<TAB>generacin
+//   comun<TAB>id<TAB>nombre<TAB>generaciones desde A<TAB>generaciones desde B
+//   parentesco<TAB>grado civil (-1 = ninguno)<TAB>descripcin
+//   consanguinidad<TAB>id<TAB>F        coancestria<TAB>idA<TAB>idB<TAB>coeficiente
+//   generacion<TAB>id<TAB>generacin<TAB>profundidad de su descendencia
+//   referencia<TAB>id@versin
+//   version<TAB>nmero<TAB>personas<TAB>nodos nuevos<TAB>bytes nuevos
+//   memoria<TAB>nodos vivos del historial<TAB>bytes
+//   alta|baja|cambio<TAB>id<TAB>nombre  (diff, en orden de ID)
+//   decada<TAB>ao inicial<TAB>nacimientos     sinfecha<TAB>personas
+//   faltan<TAB>sin padre<TAB>sin madre<TAB>sin ninguno
+//   nombre<TAB>nombre de pila<TAB>personas
+// Comandos (nombres con espacios entre comillas; "-" o 0 = sin dato):
+//   add "nombre" fecha [padre] [madre]    del id        find id
+//   parents id [padre] [madre]            (cambia los padres; sin ciclos)
+//   gen id                                (generacin y profundidad)
+//   ref id                                (referencia id@versin)
+//   publish                               (publica la vista para lectores)
+//   history on [limite] | off             (versiona cada cambio; conserva las
+//                                         ltimas 'limite', 1000 por omisin)
+//   history                               asof version id      diff vA vB
+//   Donde se pide un id vale tambin una referencia id@versin: si esa
+//   persona fue eliminada el comando falla aunque el ID se haya reusado.
+//   Las versiones valen mientras dure el proceso.
+//   name prefix|fold|exact "texto"        (personas por nombre, ver buscarPorNombre)
+//   born desde hasta [limite]             count-born desde hasta
+//   kin idA idB                           (parentesco de A respecto de B)
+//   inbreeding [ruta|-] [hilos]           (F de Wright de todos; con ruta,
+//                                         TSV id<TAB>F al archivo)
+//   kinship idA idB                       (coeficiente de parentesco de Wright)
+//   report [hilos] [nombres]              (informe de poblacin en paralelo:
+//                                         dcadas, faltantes y los 'nombres'
+//                                         nombres de pila ms comunes, 20)
+//     (aos o dd/mm/aaaa, "-" = abierto; born lista en orden cronolgico)
+//   ancestors id [generaciones]           descendants id [generaciones]
+//   traverse pre|in|post|bfs|morris [limite] [desde]
+//   import ruta                           save
+// Las lneas vacas o que empiezan con '#' se ignoran. Las fechas se validan
+// como en la importacin: calendario correcto, sin lmite de aos.
+// =============================================================================
+struct EstadoLotes {
+    long linea;
+    long comandos;
+    long errores;
+    bool persistir;                 // false: sin instantnea ni registro
+    CierreAncestros cierre;
+    Parentesco parentesco;
+    ListaEnteros ids;
+    ListaEnteros niveles;
+};
+
+EstadoLotes lotes;
+
+void errorLote(const char* comando, const char* mensaje) {
+    Salida &s = salidaEstandar;
+    lotes.errores++;
+    escribirTexto(s, "error\t");
+    escribirTexto(s, comando);
+    escribirCaracter(s, '\t');
+    escribirEntero(s, lotes.linea);
+    escribirCaracter(s, '\t');
+    escribirTexto(s, mensaje);
+    escribirCaracter(s, '\n');
+}
+
+void okLote(const char* comando, long dato) {
+    Salida &s = salidaEstandar;
+    escribirTexto(s, "ok\t");
+    escribirTexto(s, comando);
+    escribirCaracter(s, '\t');
+    escribirEntero(s, dato);
+    escribirCaracter(s, '\n');
+}
+
+// Fila "tipo<TAB>id<TAB>nombre<TAB>generacin" de ancestros y descendientes.
+void filaParienteLote(const char* tipo, Persona* p, int generacion) {
+    Salida &s = salidaEstandar;
+    escribirTexto(s, tipo);
+    escribirCaracter(s, '\t');
+    escribirEntero(s, p->id);
+    escribirCaracter(s, '\t');
+    escribirCadena(s, p->nombre);
+    escribirCaracter(s, '\t');
+    escribirEntero(s, generacion);
+    escribirCaracter(s, '\n');
+}
+
+void filaDiferencia(const NodoVersion* antes, const NodoVersion* despues) {
+    Salida &s = salidaEstandar;
+    const NodoVersion* r = despues != NULL ? despues : antes;
+    escribirTexto(s, antes == NULL ? "alta\t" : despues == NULL ? "baja\t" : "cambio\t");
+    escribirEntero(s, r->id);
+    escribirCaracter(s, '\t');
+    escribirCadena(s, r->nombre);
+    escribirCaracter(s, '\n');
+}
+
+// Persona nombrada por "id" o por una referencia "id@versin" (ver ref);
+// con versin, NULL si la referencia qued vieja.
+Persona* leerPersonaLote(const char* campo) {
+    int id = leerEntero(campo);
+    const char* arroba = strchr(campo, '@');
+    if (arroba == NULL) return buscarPorID(id);
+    RefPersona r = {id, (unsigned int)strtoul(arroba + 1, NULL, 10)};
+    return resolverReferencia(r);
+}
+
+// RETORNO: false si el campo no es "-", 0 ni el ID de alguien cargado.
+bool leerProgenitor(const char* campo, Persona* &p) {
+    p = NULL;
+    if (strcmp(campo, "-") == 0 || (leerEntero(campo) == 0 && strchr(campo, '@') == NULL)) return true;
+    p = leerPersonaLote(campo);
+    return p != NULL;
+}
+
+// RETORNO: la persona del campo, o NULL (ya informado como error).
+Persona* personaDeLote(const char* comando, char* campos[], int n) {
+    if (n < 2) {
+        errorLote(comando, "falta el id");
+        return NULL;
+    }
+    Persona* p = leerPersonaLote(campos[1]);
+    if (p == NULL) {
+        errorLote(comando, strchr(campos[1], '@') != NULL && buscarPorID(leerEntero(campos[1])) != NULL
+                           ? "referencia vencida" : "no existe");
+    }
+    return p;
+}
+
+void loteAncestros(Persona* p, int generaciones) {
+    calcularAncestros(p, lotes.cierre, generaciones);
+    for (int i = 1; i < lotes.cierre.ids.cantidad; i++) {
+        filaParienteLote("ancestro", buscarPorID(lotes.cierre.ids.datos[i]), lotes.cierre.distanciaMinima[i]);
+    }
+    okLote("ancestors", lotes.cierre.ids.cantidad - 1);
+}
+
+// Descendientes por niveles (BFS): cada uno una vez, con su generacin mnima.
+void loteDescendientes(Persona* p, int generaciones) {
+    nuevaVisita(marcasDescendientes, limiteCeldas());
+    marcarVisitado(marcasDescendientes, p->celda);
+    lotes.ids.cantidad = 0;
+    lotes.niveles.cantidad = 0;
+    agregarEntero(lotes.ids, p->id);
+    agregarEntero(lotes.niveles, 0);
+    
+    for (int i = 0; i < lotes.ids.cantidad; i++) {
+        int nivel = lotes.niveles.datos[i];
+        if (nivel > 0) {
+            filaParienteLote("descendiente", buscarPorID(lotes.ids.datos[i]), nivel);
+        }
+        if (generaciones > 0 && nivel >= generaciones) continue;
+        int n = cantidadHijos(lotes.ids.datos[i]);
+        int* hijos = hijosDe(lotes.ids.datos[i]);
+        for (int k = 0; k < n; k++) {
+            Persona* h = buscarPorID(hijos[k]);
+            if (h != NULL && marcarVisitado(marcasDescendientes, h->celda)) {
+                agregarEntero(lotes.ids, hijos[k]);
+                agregarEntero(lotes.niveles, nivel + 1);
+            }
+        }
+    }
+    okLote("descendants", lotes.ids.cantidad - 1);
+}
+
+void ejecutarComando(Persona* &arbol, char* campos[], int n) {
+    const char* comando = campos[0];
+    
+    if (strcmp(comando, "add") == 0) {
+        if (n < 3) {
+            errorLote(comando, "uso: add \"nombre\" fecha [padre] [madre]");
+            return;
+        }
+        Fecha fecha = FECHA_DESCONOCIDA;
+        if (strcmp(campos[2], "-") != 0 && !parsearFecha(campos[2], fecha)) {
+            errorLote(comando, "fecha invalida");
+            return;
+        }
+        Persona* padre;
+        Persona* madre;
+        if (!leerProgenitor(n > 3 ? campos[3] : "-", padre)) {
+            errorLote(comando, "el padre no existe");
+            return;
+        }
+        if (!leerProgenitor(n > 4 ? campos[4] : "-", madre)) {
+            errorLote(comando, "la madre no existe");
+            return;
+        }
+        Persona* p = agregarPersona(arbol, proximoID, guardarCadena(campos[1], (int)strlen(campos[1])),
+                                    fecha, padre, madre);
+        if (p == NULL) {
+            errorLote(comando, "no se pudo agregar");
+            return;
+        }
+        proximoID++;
+        if (!asegurarRegistro()) {
+            errorLote(comando, "no se pudo anotar en el registro");
+            return;
+        }
+        okLote(comando, p->id);
+    } else if (strcmp(comando, "del") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        int id = p->id;
+        quitarPersona(arbol, id);
+        if (!asegurarRegistro()) {
+            errorLote(comando, "no se pudo anotar en el registro");
+            return;
+        }
+        okLote(comando, id);
+    } else if (strcmp(comando, "parents") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        Persona* padre;
+        Persona* madre;
+        if (!leerProgenitor(n > 2 ? campos[2] : "-", padre)) {
+            errorLote(comando, "el padre no existe");
+            return;
+        }
+        if (!leerProgenitor(n > 3 ? campos[3] : "-", madre)) {
+            errorLote(comando, "la madre no existe");
+            return;
+        }
+        if (!asignarPadres(p, padre, madre)) {
+            errorLote(comando, "formaria un ciclo");
+            return;
+        }
+        if (!asegurarRegistro()) {
+            errorLote(comando, "no se pudo anotar en el registro");
+            return;
+        }
+        okLote(comando, p->id);
+    } else if (strcmp(comando, "ref") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        RefPersona r = referenciaA(p);
+        Salida &s = salidaEstandar;
+        escribirTexto(s, "referencia\t");
+        escribirEntero(s, r.id);
+        escribirCaracter(s, '@');
+        escribirEntero(s, r.version);
+        escribirCaracter(s, '\n');
+        okLote(comando, 1);
+    } else if (strcmp(comando, "publish") == 0) {
+        publicarVista();
+        okLote(comando, vistas.actual.load()->cantidad);
+    } else if (strcmp(comando, "history") == 0) {
+        if (n > 1 && strcmp(campos[1], "on") == 0) {
+            activarHistorial(n > 2 && leerEntero(campos[2]) > 0 ? leerEntero(campos[2]) : 1000);
+            okLote(comando, historial.ultimoNumero);
+        } else if (n > 1 && strcmp(campos[1], "off") == 0) {
+            desactivarHistorial();
+            okLote(comando, 0);
+        } else if (!historial.activo) {
+            errorLote(comando, "el historial no esta activo (history on [limite])");
+        } else {
+            Salida &s = salidaEstandar;
+            for (int k = 0; k < historial.cantidad; k++) {
+                Version &v = versionEn(k);
+                escribirTexto(s, "version\t");
+                escribirEntero(s, v.numero);
+                escribirCaracter(s, '\t');
+                escribirEntero(s, v.personas);
+                escribirCaracter(s, '\t');
+                escribirEntero(s, v.nodosNuevos);
+                escribirCaracter(s, '\t');
+                escribirEntero(s, v.nodosNuevos * (long)sizeof(NodoVersion));
+                escribirCaracter(s, '\n');
+            }
+            escribirTexto(s, "memoria\t");
+            escribirEntero(s, historial.nodosVivos);
+            escribirCaracter(s, '\t');
+            escribirEntero(s, historial.nodosVivos * (long)sizeof(NodoVersion));
+            escribirCaracter(s, '\n');
+            okLote(comando, historial.cantidad);
+        }
+    } else if (strcmp(comando, "asof") == 0) {
+        Version* v = n > 2 ? buscarVersion(leerEntero(campos[1])) : NULL;
+        if (v == NULL) {
+            errorLote(comando, "uso: asof version id (version conservada)");
+            return;
+        }
+        const NodoVersion* r = buscarEnVersion(v->raiz, leerEntero(campos[2]));
+        if (r == NULL) {
+            errorLote(comando, "no existe en esa version");
+            return;
+        }
+        Salida &s = salidaEstandar;
+        escribirTexto(s, "persona\t");
+        escribirEntero(s, r->id);
+        escribirCaracter(s, '\t');
+        escribirCadena(s, r->nombre);
+        escribirCaracter(s, '\t');
+        if (r->fecha == FECHA_DESCONOCIDA) escribirCaracter(s, '-');
+        else escribirFecha(s, r->fecha);
+        escribirCaracter(s, '\t');
+        if (r->padre < 0) escribirCaracter(s, '-');
+        else escribirEntero(s, r->padre);
+        escribirCaracter(s, '\t');
+        if (r->madre < 0) escribirCaracter(s, '-');
+        else escribirEntero(s, r->madre);
+        escribirCaracter(s, '\n');
+        okLote(comando, 1);
+    } else if (strcmp(comando, "diff") == 0) {
+        Version* a = n > 2 ? buscarVersion(leerEntero(campos[1])) : NULL;
+        Version* b = n > 2 ? buscarVersion(leerEntero(campos[2])) : NULL;
+        if (a == NULL || b == NULL) {
+            errorLote(comando, "uso: diff versionA versionB (versiones conservadas)");
+            return;
+        }
+        okLote(comando, compararVersiones(a->raiz, b->raiz, filaDiferencia));
+    } else if (strcmp(comando, "gen") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        Salida &s = salidaEstandar;
+        escribirTexto(s, "generacion\t");
+        escribirEntero(s, p->id);
+        escribirCaracter(s, '\t');
+        escribirEntero(s, p->generacion);
+        escribirCaracter(s, '\t');
+        escribirEntero(s, p->profundidad);
+        escribirCaracter(s, '\n');
+        okLote(comando, 1);
+    } else if (strcmp(comando, "find") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        comenzarListado(salidaEstandar, LISTADO_TSV, 0, 0, "persona");
+        listarPersona(p);
+        terminarListado(false);
+        okLote(comando, 1);
+    } else if (strcmp(comando, "name") == 0) {
+        if (n < 3) {
+            errorLote(comando, "uso: name prefix|fold|exact \"texto\"");
+            return;
+        }
+        ModoNombre modo;
+        if (strcmp(campos[1], "prefix") == 0) modo = NOMBRE_PREFIJO;
+        else if (strcmp(campos[1], "fold") == 0) modo = NOMBRE_PLEGADO;
+        else if (strcmp(campos[1], "exact") == 0) modo = NOMBRE_EXACTO;
+        else {
+            errorLote(comando, "modo desconocido (prefix, fold, exact)");
+            return;
+        }
+        lotes.ids.cantidad = 0;
+        buscarPorNombre(campos[2], (int)strlen(campos[2]), modo, lotes.ids);
+        comenzarListado(salidaEstandar, LISTADO_TSV, 0, 0, "persona");
+        for (int i = 0; i < lotes.ids.cantidad; i++) {
+            listarPersona(buscarPorID(lotes.ids.datos[i]));
+        }
+        terminarListado(false);
+        okLote(comando, lotes.ids.cantidad);
+    } else if (strcmp(comando, "born") == 0 || strcmp(comando, "count-born") == 0) {
+        Fecha desde, hasta;
+        if (n < 3) {
+            errorLote(comando, "uso: born|count-born desde hasta [limite]");
+            return;
+        }
+        if (!leerLimiteFecha(campos[1], false, desde) || !leerLimiteFecha(campos[2], true, hasta)) {
+            errorLote(comando, "fecha invalida");
+            return;
+        }
+        if (comando[0] == 'c') {
+            okLote(comando, contarNacidos(desde, hasta));
+            return;
+        }
+        long limite = n > 3 ? leerEntero(campos[3]) : 0;
+        comenzarListado(salidaEstandar, LISTADO_TSV, 0, limite, "persona");
+        recorrerNacidos(desde, hasta, listarPersona, limite > 0 ? limite : 0);
+        terminarListado(false);
+        okLote(comando, listado.emitidas);
+    } else if (strcmp(comando, "kin") == 0) {
+        Persona* a = personaDeLote(comando, campos, n);
+        if (a == NULL) return;
+        Persona* b = personaDeLote(comando, campos + 1, n - 1);
+        if (b == NULL) return;
+        calcularParentesco(a, b, lotes.parentesco);
+        Parentesco &r = lotes.parentesco;
+        Salida &s = salidaEstandar;
+        for (int i = 0; i < r.comunes.cantidad; i++) {
+            Persona* c = buscarPorID(r.comunes.datos[i]);
+            escribirTexto(s, "comun\t");
+            escribirEntero(s, c->id);
+            escribirCaracter(s, '\t');
+            escribirCadena(s, c->nombre);
+            escribirCaracter(s, '\t');
+            escribirEntero(s, r.distanciasA.datos[i]);
+            escribirCaracter(s, '\t');
+            escribirEntero(s, r.distanciasB.datos[i]);
+            escribirCaracter(s, '\n');
+        }
+        escribirTexto(s, "parentesco\t");
+        escribirEntero(s, r.comunes.cantidad > 0 ? r.distancia : -1);
+        escribirCaracter(s, '\t');
+        escribirTexto(s, describirParentesco(a, b, r).c_str());
+        escribirCaracter(s, '\n');
+        okLote(comando, r.comunes.cantidad);
+    } else if (strcmp(comando, "inbreeding") == 0) {
+        int hilos = n > 2 ? leerEntero(campos[2]) : 0;
+        if (hilos < 0 || hilos > 256) {
+            errorLote(comando, "cantidad de hilos invalida");
+            return;
+        }
+        calcularConsanguinidad(hilos);
+        if (n > 1 && strcmp(campos[1], "-") != 0) {
+            long filas = guardarConsanguinidad(campos[1]);
+            if (filas < 0) errorLote(comando, strerror(errno));
+            else okLote(comando, filas);
+        } else {
+            okLote(comando, escribirConsanguinidad(salidaEstandar, "consanguinidad"));
+        }
+    } else if (strcmp(comando, "kinship") == 0) {
+        Persona* a = personaDeLote(comando, campos, n);
+        if (a == NULL) return;
+        Persona* b = personaDeLote(comando, campos + 1, n - 1);
+        if (b == NULL) return;
+        Salida &s = salidaEstandar;
+        escribirTexto(s, "coancestria\t");
+        escribirEntero(s, a->id);
+        escribirCaracter(s, '\t');
+        escribirEntero(s, b->id);
+        escribirCaracter(s, '\t');
+        escribirDecimal(s, coeficienteParentesco(a, b), 6);
+        escribirCaracter(s, '\n');
+        okLote(comando, 1);
+    } else if (strcmp(comando, "report") == 0) {
+        int hilos = n > 1 ? leerEntero(campos[1]) : 0;
+        int cantidad = n > 2 ? leerEntero(campos[2]) : 20;
+        if (hilos < 0 || hilos > 256) {
+            errorLote(comando, "cantidad de hilos invalida");
+            return;
+        }
+        if (cantidad < 0) {
+            errorLote(comando, "cantidad de nombres invalida");
+            return;
+        }
+        InformePoblacion* inf = new InformePoblacion;
+        reducirPersonas(REDUCCION_INFORME, inf, hilos);
+        Salida &s = salidaEstandar;
+        for (int i = 0; i < NUM_DECADAS; i++) {
+            if (inf->porDecada[i] == 0) continue;
+            escribirTexto(s, "decada\t");
+            escribirEntero(s, i * 10);
+            escribirCaracter(s, '\t');
+            escribirEntero(s, inf->porDecada[i]);
+            escribirCaracter(s, '\n');
+        }
+        escribirTexto(s, "sinfecha\t");
+        escribirEntero(s, inf->sinFecha);
+        escribirTexto(s, "\nfaltan\t");
+        escribirEntero(s, inf->sinPadre);
+        escribirCaracter(s, '\t');
+        escribirEntero(s, inf->sinMadre);
+        escribirCaracter(s, '\t');
+        escribirEntero(s, inf->sinNinguno);
+        escribirCaracter(s, '\n');
+        int filas = 0;
+        EntradaFrecuencia* comunes = nombresMasFrecuentes(*inf, cantidad, &filas);
+        for (int i = 0; i < filas; i++) {
+            escribirTexto(s, "nombre\t");
+            escribirBytes(s, comunes[i].texto, comunes[i].largo);
+            escribirCaracter(s, '\t');
+            escribirEntero(s, comunes[i].cantidad);
+            escribirCaracter(s, '\n');
+        }
+        delete[] comunes;
+        okLote(comando, inf->personas);
+        liberarInforme(inf);
+        delete inf;
+    } else if (strcmp(comando, "ancestors") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        loteAncestros(p, n > 2 ? leerEntero(campos[2]) : 0);
+    } else if (strcmp(comando, "descendants") == 0) {
+        Persona* p = personaDeLote(comando, campos, n);
+        if (p == NULL) return;
+        loteDescendientes(p, n > 2 ? leerEntero(campos[2]) : 0);
+    } else if (strcmp(comando, "traverse") == 0) {
+        const char* modo = n > 1 ? campos[1] : "in";
+        void (*recorrer)(Persona*, VisitaPersona) = NULL;
+        if (strcmp(modo, "pre") == 0) recorrer = recorrerPreorden;
+        else if (strcmp(modo, "in") == 0) recorrer = recorrerInorden;
+        else if (strcmp(modo, "post") == 0) recorrer = recorrerPostorden;
+        else if (strcmp(modo, "bfs") == 0) recorrer = recorrerPorNiveles;
+        else if (strcmp(modo, "morris") == 0) recorrer = recorrerInordenMorris;
+        else {
+            errorLote(comando, "modo desconocido (pre, in, post, bfs, morris)");
+            return;
+        }
+        comenzarListado(salidaEstandar, LISTADO_TSV, n > 3 ? leerEntero(campos[3]) : 0,
+                        n > 2 ? leerEntero(campos[2]) : 0, "persona");
+        listarConRecorrido(arbol, recorrer);
+        terminarListado(false);
+        okLote(comando, listado.emitidas);
+    } else if (strcmp(comando, "import") == 0) {
+        ResultadoImportacion res;
+        if (n < 2 || !importarArchivo(arbol, campos[1], res)) {
+            errorLote(comando, "no se pudo abrir el archivo");
+            return;
+        }
+        if (lotes.persistir) puntoDeControl(ARCHIVO_INSTANTANEA);
+        if (vistas.actual.load() != NULL) publicarVista();
+        okLote(comando, res.importados);
+    } else if (strcmp(comando, "save") == 0) {
+        if (!lotes.persistir || !puntoDeControl(ARCHIVO_INSTANTANEA)) {
+            errorLote(comando, "no se pudo guardar");
+            return;
+        }
+        okLote(comando, estadisticasAVL.nodos);
+    } else {
+        errorLote(comando, "comando desconocido");
+    }
+}
+
+// RETORNO: cantidad de comandos con error, -1 si no se pudo abrir la entrada.
+long ejecutarLotes(const char* ruta, bool persistir) {
+    LectorBuffer* l = abrirLector(ruta);
+    if (l == NULL) {
+        cerr << "No se pudo abrir " << ruta << "\n";
+        return -1;
+    }
+    Persona* arbol = NULL;
+    if (persistir) {
+        cargarInstantanea(arbol, ARCHIVO_INSTANTANEA);
+        reaplicarRegistro(arbol, ARCHIVO_REGISTRO);
+        abrirRegistro(ARCHIVO_REGISTRO, politicaSync, intervaloSyncMs);
+    }
+    lotes.linea = lotes.comandos = lotes.errores = 0;
+    lotes.persistir = persistir;
+    inicializarCierre(lotes.cierre);
+    inicializarParentesco(lotes.parentesco);
+    inicializarEnteros(lotes.ids);
+    inicializarEnteros(lotes.niveles);
+    
+    chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+    char* linea;
+    int largo;
+    char* campos[8];
+    while (siguienteLinea(l, linea, largo)) {
+        lotes.linea++;
+        for (int i = 0; i < largo; i++) {
+            if (linea[i] == '\t') linea[i] = ' ';
+        }
+        while (largo > 0 && linea[largo - 1] == ' ') linea[--largo] = '\0';
+        while (*linea == ' ') linea++;
+        if (*linea == '\0' || *linea == '#') continue;
         
-        if (nodosContados == nodosNivel) {
-            cout << "\n";
-            nivelActual++;
-            nodosNivel *= 2;
-            nodosContados = 0;
+        int n = dividirCampos(linea, ' ', campos, 8);
+        lotes.comandos++;
+        if (l->cortada) {
+            errorLote(campos[0], "linea demasiado larga");
+            continue;
         }
+        ejecutarComando(arbol, campos, n);
+    }
+    cerrarLector(l);
+    double segundos = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    
+    if (persistir) {
+        puntoDeControl(ARCHIVO_INSTANTANEA);
+        cerrarRegistro();
     }
-    if (nodosContados > 0) cout << "\n";
+    liberarSalida(salidaEstandar);
+    cerr << lotes.comandos << " comandos, " << lotes.errores << " errores, " << fixed << setprecision(3)
+         << segundos << " s (" << setprecision(0) << (segundos > 0 ? lotes.comandos / segundos : 0)
+         << " comandos/s)\n";
+    
+    liberarCierre(lotes.cierre);
+    liberarParentesco(lotes.parentesco);
+    liberarConsanguinidad();
+    liberarVistas();
+    cerrarPiscina();
+    liberarEnteros(lotes.ids);
+    liberarEnteros(lotes.niveles);
+    vaciarBase(arbol);
+    return lotes.errores;
 }
 
 // =============================================================================
 // MEN PRINCIPAL
 // =============================================================================
+
+// Lee un nmero en su propia lnea; ENTER solo deja el valor por defecto.
+long pedirEntero(const char* pregunta, long porDefecto) {
+    cout << pregunta;
+    string linea;
+    getline(cin, linea);
+    int valor = leerEntero(linea.c_str());
+    return valor < 0 ? porDefecto : valor;
+}
+
 void menu() {
     Persona* arbol = NULL;
     int opcion, id_padre, id_madre;
     string nombre, fecha;
     
+    cargarInstantanea(arbol, ARCHIVO_INSTANTANEA);
+    reaplicarRegistro(arbol, ARCHIVO_REGISTRO);
+    abrirRegistro(ARCHIVO_REGISTRO, politicaSync, intervaloSyncMs);
+    
     while (true) {
         system("clear || cls");
         
@@ -353,7 +6520,14 @@ void menu() {
         cout << "  5. Mostrar ancestros                                                     \n";
         cout << "  6. Mostrar descendientes                                                 \n";
         cout << "  7. Ver recorridos del arbol                                              \n";
-        cout << "  8. Salir                                                                 \n";
+        cout << "  8. Estadisticas del indice                                               \n";
+        cout << "  9. Importar archivo (CSV / GEDCOM)                                       \n";
+        cout << " 10. Buscar por nombre                                                     \n";
+        cout << " 11. Nacidos entre fechas                                                  \n";
+        cout << " 12. Parentesco entre dos personas                                         \n";
+        cout << " 13. Coeficientes de consanguinidad                                        \n";
+        cout << " 14. Asignar padres                                                        \n";
+        cout << " 15. Salir                                                                 \n";
         cout << "+---------------------------------------------------------------------------+\n";
         cout << "Ingrese opcion: ";
         cin >> opcion;
@@ -373,11 +6547,12 @@ void menu() {
                 cout << "Ingrese nombre: ";
                 getline(cin, nombre);
                 
+                Fecha fechaNac;
                 bool fechaValida = false;
                 while (!fechaValida) {
                     cout << "Ingrese fecha de nacimiento (dd/mm/aaaa): ";
                     cin >> fecha;
-                    if (esValida(fecha)) {
+                    if (esValida(fecha, fechaNac)) {
                         fechaValida = true;
                     } else {
                         cout << " Fecha invalida. Intente de nuevo (formato: dd/mm/aaaa, 1900-2025)\n";
@@ -397,18 +6572,18 @@ void menu() {
                 if (respuesta == 's' || respuesta == 'S') {
                     cout << "ID del padre (0 si no existe): ";
                     cin >> id_padre;
-                    padre = (id_padre != 0) ? buscar(arbol, id_padre) : NULL;
+                    padre = (id_padre != 0) ? buscarPorID(id_padre) : NULL;
                     
                     cout << "ID de la madre (0 si no existe): ";
                     cin >> id_madre;
-                    madre = (id_madre != 0) ? buscar(arbol, id_madre) : NULL;
+                    madre = (id_madre != 0) ? buscarPorID(id_madre) : NULL;
                     cin.ignore();
                 }
                 
-                insertar(arbol, nuevoID, nombre, fecha, padre, madre);
-                agregarATabla(buscar(arbol, nuevoID));
+                agregarPersona(arbol, nuevoID, guardarCadena(nombre), fechaNac, padre, madre);
                 
                 cout << "\n  Persona agregada correctamente\n";
+                if (!asegurarRegistro()) cout << "  Aviso: no se pudo anotar en el registro\n";
                 cout << "\n Presione ENTER para continuar...";
                 cin.get();
                 break;
@@ -424,10 +6599,9 @@ void menu() {
                 cout << "ID a eliminar: ";
                 cin >> id;
                 
-                Persona* encontrado = buscar(arbol, id);
-                if (encontrado != NULL) {
-                    arbol = eliminar(arbol, id);
+                if (quitarPersona(arbol, id)) {
                     cout << "\n Persona eliminada correctamente \n";
+                    if (!asegurarRegistro()) cout << " Aviso: no se pudo anotar en el registro\n";
                 } else {
                     cout << "\n Persona no encontrada\n";
                 }
@@ -448,12 +6622,19 @@ void menu() {
                 cout << "ID a buscar: ";
                 cin >> id;
                 
-                Persona* encontrado = buscar(arbol, id);
+                Persona* encontrado = buscarPorID(id);
                 if (encontrado != NULL) {
                     cout << "\n Encontrado:\n";
                     cout << "  ID: " << encontrado->id << "\n";
                     cout << "  Nombre: " << encontrado->nombre << "\n";
                     cout << "  Fecha: " << encontrado->fecha_nac << "\n";
+                    if (encontrado->fecha_nac.valor != 0) {
+                        cout << "  Edad: " << edadEn(encontrado->fecha_nac, fechaActual()) << " anios\n";
+                    }
+                    cout << "  Generacion: " << encontrado->generacion;
+                    if (encontrado->generacion == 0) cout << " (fundador)";
+                    cout << "\n";
+                    cout << "  Descendencia: " << encontrado->profundidad << " generaciones\n";
                 } else {
                     cout << "\n No encontrado\n";
                 }
@@ -466,37 +6647,13 @@ void menu() {
                 
             case 4: {
                 system("clear || cls");
-                inicializarTabla();
-                llenarTabla(arbol);
-                
-                cout << "\n+----------------------------------------------------------------------------+\n";
-                cout << "                          TABLA DE PERSONAS                                  \n";
-                cout << "----------------------------------------------------------------------------\n";
-                cout << " ID   NOMBRE                FECHA NACIMIENTO  PADRE   MADRE             \n";
-                cout << "----------------------------------------------------------------------------\n";
-                
-                for (int i = 0; i < tablaGlobal.cantidad; i++) {
-                    Persona* p = tablaGlobal.personas[i];
-                    cout << " " << setw(3) << p->id << "  " << setw(20) << left << p->nombre 
-                         << " " << setw(16) << p->fecha_nac << " ";
-                    
-                    if (p->padre != NULL) {
-                        cout << setw(6) << left << p->padre->id;
-                    } else {
-                        cout << setw(6) << left << "N/A";
-                    }
-                    
-                    cout << " ";
-                    if (p->madre != NULL) {
-                        cout << setw(17) << left << p->madre->nombre << "\n";
-                    } else {
-                        cout << setw(17) << left << "N/A" << "\n";
-                    }
-                }
+                long formato = pedirEntero("Formato (1 = tabla, 2 = TSV, 3 = JSON) [1]: ", 1);
+                long desde = pedirEntero("Desde la fila [0]: ", 0);
+                long cantidad = pedirEntero("Cantidad de filas (0 = todas) [0]: ", 0);
                 
-                cout << "+----------------------------------------------------------------------------+\n";
+                mostrarTabla(formato == 2 ? LISTADO_TSV : formato == 3 ? LISTADO_JSON : LISTADO_TABLA,
+                             desde, cantidad);
                 cout << "\n Presione ENTER para continuar...";
-                cin.ignore();
                 cin.get();
                 break;
             }
@@ -511,10 +6668,15 @@ void menu() {
                 cout << "ID para ver ancestros: ";
                 cin >> id;
                 
-                Persona* p = buscar(arbol, id);
+                int generaciones;
+                cout << "Generaciones a mostrar (0 = todas): ";
+                cin >> generaciones;
+                
+                Persona* p = buscarPorID(id);
                 if (p != NULL) {
                     cout << "\n";
-                    mostrarAncestros(p);
+                    mostrarAncestros(p, generaciones);
+                    mostrarResumenAncestros(p, generaciones);
                 } else {
                     cout << "\n Persona no encontrada \n";
                 }
@@ -535,10 +6697,14 @@ void menu() {
                 cout << "ID para ver descendientes: ";
                 cin >> id;
                 
-                Persona* p = buscar(arbol, id);
+                int generaciones;
+                cout << "Generaciones a mostrar (0 = todas): ";
+                cin >> generaciones;
+                
+                Persona* p = buscarPorID(id);
                 if (p != NULL) {
                     cout << "\n";
-                    mostrarDescendientes(p);
+                    mostrarDescendientes(p, generaciones);
                 } else {
                     cout << "\n Persona no encontrada\n";
                 }
@@ -558,7 +6724,8 @@ void menu() {
                 cout << "  2. Inorden (Izquierda - Raiz - Derecha)                                \n";
                 cout << "  3. Postorden (Izquierda - Derecha - Raiz)                              \n";
                 cout << "  4. Por Niveles (BFS)                                                   \n";
-                cout << "  5. Volver al menu principal                                            \n";
+                cout << "  5. Inorden sin pila (Morris)                                           \n";
+                cout << "  6. Volver al menu principal                                            \n";
                 cout << "+---------------------------------------------------------------------------+\n";
                 cout << "Ingrese opcion: ";
                 
@@ -566,6 +6733,12 @@ void menu() {
                 cin >> opcionRecorrido;
                 cin.ignore();
                 
+                long desde = 0, cantidad = 0;
+                if (opcionRecorrido >= 1 && opcionRecorrido <= 5 && arbol != NULL) {
+                    desde = pedirEntero("Desde la fila [0]: ", 0);
+                    cantidad = pedirEntero("Cantidad de filas (0 = todas) [0]: ", 0);
+                }
+                
                 if (arbol == NULL) {
                     cout << "\n  El arbol esta vacio \n";
                     cout << "Presione ENTER para continuar...";
@@ -581,7 +6754,7 @@ void menu() {
                         cout << "                    RECORRIDO PREORDEN \n";
                         cout << "                 (Raz - Izquierda - Derecha)\n";
                         cout << "---------------------------------------------------------------------------\n\n";
-                        preorden(arbol);
+                        preorden(arbol, desde, cantidad);
                         break;
                     }
                     case 2: {
@@ -589,7 +6762,7 @@ void menu() {
                         cout << "                    RECORRIDO INORDEN \n";
                         cout << "                 (Izquierda - Raz - Derecha)\n";
                         cout << "---------------------------------------------------------------------------\n\n";
-                        inorden(arbol);
+                        inorden(arbol, desde, cantidad);
                         break;
                     }
                     case 3: {
@@ -597,17 +6770,24 @@ void menu() {
                         cout << "                   RECORRIDO POSTORDEN \n";
                         cout << "                 (Izquierda - Derecha - Raz)\n";
                         cout << "---------------------------------------------------------------------------\n\n";
-                        postorden(arbol);
+                        postorden(arbol, desde, cantidad);
                         break;
                     }
                     case 4: {
                         cout << "\n---------------------------------------------------------------------------\n";
                         cout << "                   RECORRIDO POR NIVELES (BFS) \n";
                         cout << "---------------------------------------------------------------------------\n\n";
-                        porNiveles(arbol);
+                        porNiveles(arbol, desde, cantidad);
                         break;
                     }
                     case 5: {
+                        cout << "\n---------------------------------------------------------------------------\n";
+                        cout << "                 RECORRIDO INORDEN SIN PILA (MORRIS) \n";
+                        cout << "---------------------------------------------------------------------------\n\n";
+                        inordenMorris(arbol, desde, cantidad);
+                        break;
+                    }
+                    case 6: {
                         break;
                     }
                     default: {
@@ -620,7 +6800,267 @@ void menu() {
                 break;
             }
                 
-            case 8: {return;  // salir del men y terminar el programa
+            case 8: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                     ESTADISTICAS DEL INDICE AVL \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                long n = estadisticasAVL.nodos;
+                cout << "  Personas            : " << n << "\n";
+                cout << "  Altura del arbol    : " << altura(arbol) << "\n";
+                cout << "  Cota AVL (1.44 log2): " << fixed << setprecision(1)
+                     << 1.4405 * log2((double)n + 2) - 0.3277 << "\n";
+                cout << "  Rotaciones simples  : " << estadisticasAVL.rotacionesSimples << "\n";
+                cout << "  Rotaciones dobles   : " << estadisticasAVL.rotacionesDobles << "\n";
+                cout << "  Arena de nodos      : " << arenaPersonas.vivos << " vivos, "
+                     << bytesReservadosArena() / 1024 << " KB reservados, "
+                     << fragmentacionArena() << "% fragmentacion\n";
+                cout << "  Indice de hijos     : " << indiceHijos.enlaces << " enlaces, "
+                     << indiceHijos.capacidad << " posiciones (" << indiceHijos.desperdicio << " sin uso)\n";
+                cout << "  Indice de nombres   : " << indiceNombres.claves << " claves, "
+                     << indiceNombres.numNodos - indiceNombres.nodosLibres
+                     << " nodos, " << bytesIndiceNombres() / 1024 << " KB\n";
+                cout << "  Indice por fecha    : " << tamanoFecha(indiceFechas.raiz) << " personas, altura "
+                     << alturaFecha(indiceFechas.raiz) << "\n";
+                cout << "  Textos de nombres   : " << monticuloCadenas.bytes / 1024 << " KB en el monticulo\n";
+                if (instantaneaActiva.base != NULL) {
+                    cout << "  Instantanea         : " << instantaneaActiva.tamano / 1024 << " KB mapeados, cargada en "
+                         << msUltimaCarga << " ms\n";
+                }
+                if (historial.activo) {
+                    cout << "  Historial           : " << historial.cantidad << " versiones, "
+                         << historial.nodosVivos << " nodos, "
+                         << historial.nodosVivos * (long)sizeof(NodoVersion) / 1024 << " KB\n";
+                }
+                if (registroOps.abierto) {
+                    cout << "  Registro (WAL)      : " << registroOps.operaciones << " operaciones, "
+                         << registroOps.sincronizaciones << " fsync, politica "
+                         << nombrePolitica(registroOps.politica);
+                    if (registroOps.errores > 0) cout << ", " << registroOps.errores << " errores";
+                    cout << "\n";
+                }
+                cout << "  Casillas por ID     : " << limiteIDs()
+                     << " (" << almacenGlobal.vivos << " ocupadas, " << almacenGlobal.lapidas << " lapidas)\n";
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.get();
+                break;
+            }
+                
+            case 9: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                     IMPORTAR ARCHIVO (CSV / GEDCOM) \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                string ruta;
+                cout << "Ruta del archivo (.csv o .ged): ";
+                getline(cin, ruta);
+                
+                ResultadoImportacion res;
+                if (importarArchivo(arbol, ruta.c_str(), res)) {
+                    // La importacin no pasa por el registro: se fija con una instantnea.
+                    puntoDeControl(ARCHIVO_INSTANTANEA);
+                    cout << "\n Importacion terminada\n\n";
+                    mostrarResultadoImportacion(res);
+                } else {
+                    cout << "\n No se pudo abrir el archivo\n";
+                }
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.get();
+                break;
+            }
+                
+            case 10: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                         BUSCAR POR NOMBRE \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                string texto;
+                cout << "Nombre o comienzo de una palabra del nombre: ";
+                getline(cin, texto);
+                long modo = pedirEntero("Coincidencia (1 = prefijo, 2 = nombre completo sin acentos, 3 = exacta) [1]: ", 1);
+                
+                ListaEnteros ids;
+                inicializarEnteros(ids);
+                buscarPorNombre(texto.data(), (int)texto.size(),
+                                modo == 2 ? NOMBRE_PLEGADO : modo == 3 ? NOMBRE_EXACTO : NOMBRE_PREFIJO, ids);
+                if (ids.cantidad == 0) {
+                    cout << "\n No se encontraron personas\n";
+                } else {
+                    cout.flush();
+                    comenzarListado(salidaEstandar, LISTADO_TABLA);
+                    for (int i = 0; i < ids.cantidad; i++) {
+                        listarPersona(buscarPorID(ids.datos[i]));
+                    }
+                    terminarListado();
+                    cout << "\n " << ids.cantidad << " personas encontradas\n";
+                }
+                liberarEnteros(ids);
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.get();
+                break;
+            }
+                
+            case 11: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                       NACIDOS ENTRE FECHAS \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                string textoDesde, textoHasta;
+                cout << "Desde (aaaa o dd/mm/aaaa, - = sin limite): ";
+                getline(cin, textoDesde);
+                cout << "Hasta (aaaa o dd/mm/aaaa, - = sin limite): ";
+                getline(cin, textoHasta);
+                
+                Fecha desdeFecha, hastaFecha;
+                if (!leerLimiteFecha(textoDesde.c_str(), false, desdeFecha)
+                    || !leerLimiteFecha(textoHasta.c_str(), true, hastaFecha)) {
+                    cout << "\n Fecha invalida\n";
+                } else {
+                    long total = contarNacidos(desdeFecha, hastaFecha);
+                    cout << "\n " << total << " personas nacidas en el rango\n";
+                    if (total > 0) {
+                        long desde = pedirEntero("Desde la fila [0]: ", 0);
+                        long cantidad = pedirEntero("Cantidad de filas (0 = todas) [0]: ", 0);
+                        cout.flush();
+                        comenzarListado(salidaEstandar, LISTADO_TABLA, desde, cantidad);
+                        recorrerNacidos(desdeFecha, hastaFecha, listarPersona, cantidad > 0 ? desde + cantidad : 0);
+                        terminarListado();
+                    }
+                }
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.get();
+                break;
+            }
+                
+            case 12: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                    PARENTESCO ENTRE DOS PERSONAS \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                int idA, idB;
+                cout << "ID de la primera persona: ";
+                cin >> idA;
+                cout << "ID de la segunda persona: ";
+                cin >> idB;
+                
+                Persona* a = buscarPorID(idA);
+                Persona* b = buscarPorID(idB);
+                if (a != NULL && b != NULL) {
+                    cout << "\n";
+                    mostrarParentesco(a, b);
+                } else {
+                    cout << "\n Persona no encontrada\n";
+                }
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.ignore();
+                cin.get();
+                break;
+            }
+                
+            case 13: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                 COEFICIENTES DE CONSANGUINIDAD (WRIGHT) \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                calcularConsanguinidad(0);
+                long total = 0, consanguineos = 0;
+                double suma = 0, maximo = 0;
+                int idMaximo = -1;
+                for (int i = 0; i < tablaGlobal.cantidad; i++) {
+                    Persona* p = tablaGlobal.personas[i];
+                    if (p == NULL) continue;
+                    double f = consanguinidad.F[p->celda];
+                    total++;
+                    suma += f;
+                    if (f > 0) consanguineos++;
+                    if (f > maximo) {
+                        maximo = f;
+                        idMaximo = p->id;
+                    }
+                }
+                cout << " Personas:                 " << total << "\n";
+                cout << " Con F > 0:                " << consanguineos << "\n";
+                cout << fixed << setprecision(6);
+                cout << " F media:                  " << (total > 0 ? suma / total : 0.0) << "\n";
+                cout << " F maxima:                 " << maximo;
+                if (idMaximo >= 0) cout << " (ID " << idMaximo << ")";
+                cout << "\n";
+                cout << setprecision(3);
+                cout << " Tiempo:                   " << consanguinidad.segundos * 1000 << " ms con "
+                     << consanguinidad.hilos << " hilos\n\n";
+                cout.unsetf(ios::fixed);
+                
+                string ruta;
+                cout << "Archivo para guardar id/F (ENTER = no guardar): ";
+                getline(cin, ruta);
+                if (!ruta.empty()) {
+                    long filas = guardarConsanguinidad(ruta.c_str());
+                    if (filas < 0) cout << "\n No se pudo escribir " << ruta << "\n";
+                    else cout << "\n " << filas << " filas escritas en " << ruta << "\n";
+                }
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.get();
+                break;
+            }
+                
+            case 14: {
+                system("clear || cls");
+                cout << "\n---------------------------------------------------------------------------\n";
+                cout << "                          ASIGNAR PADRES \n";
+                cout << "---------------------------------------------------------------------------\n\n";
+                
+                int id;
+                cout << "ID de la persona: ";
+                cin >> id;
+                Persona* p = buscarPorID(id);
+                if (p == NULL) {
+                    cout << "\n Persona no encontrada\n";
+                } else {
+                    cout << "ID del padre (0 si no tiene): ";
+                    cin >> id_padre;
+                    cout << "ID de la madre (0 si no tiene): ";
+                    cin >> id_madre;
+                    Persona* padre = id_padre != 0 ? buscarPorID(id_padre) : NULL;
+                    Persona* madre = id_madre != 0 ? buscarPorID(id_madre) : NULL;
+                    if ((id_padre != 0 && padre == NULL) || (id_madre != 0 && madre == NULL)) {
+                        cout << "\n Padre o madre no encontrado\n";
+                    } else if (!asignarPadres(p, padre, madre)) {
+                        cout << "\n No se puede: formaria un ciclo\n";
+                    } else {
+                        cout << "\n Padres asignados. Generacion: " << p->generacion << "\n";
+                        if (!asegurarRegistro()) cout << " Aviso: no se pudo anotar en el registro\n";
+                    }
+                }
+                
+                cout << "\n Presione ENTER para continuar...";
+                cin.ignore();
+                cin.get();
+                break;
+            }
+                
+            case 15: {
+                if (!puntoDeControl(ARCHIVO_INSTANTANEA)) {
+                    cout << "\n No se pudo guardar " << ARCHIVO_INSTANTANEA << "\n";
+                }
+                cerrarRegistro();
+                vaciarBase(arbol);
+                liberarConsanguinidad();
+                liberarVistas();
+                cerrarPiscina();
+                liberarSalida(salidaEstandar);
+                return;  // salir del men y terminar el programa
               }
             	
                 
@@ -638,8 +7078,76 @@ void menu() {
 
 // =============================================================================
 // FUNCIN: main
+// Opciones:
+//   --sync=siempre | --sync=grupo[:ms] | --sync=nunca   (por defecto grupo:5)
+//   --bench-wal [n]   mide las altas con cada poltica y termina
+//   --bench-consanguinidad [n]  mide el clculo de F sobre un pedigr
+//                     sinttico de n personas con 1, 2, 4... hilos y termina
+//   --bench-lectores [n]  mide lecturas concurrentes sobre vistas publicadas
+//                     con 1, 2, 4... lectores y un escritor, y termina
+//   --bench-reduccion [n]  mide el informe de poblacin en paralelo sobre
+//                     n personas sintticas con 1, 2, 4... hilos y termina
+//   --batch [archivo] ejecuta los comandos del archivo (o de la entrada
+//                     estndar) en modo por lotes y termina
+//   --sin-persistencia  con --batch: no lee ni escribe instantnea ni registro
 // =============================================================================
-int main() {
+int main(int argc, char* argv[]) {
+    long medirAltas = 0;
+    long medirConsang = 0;
+    long medirLecturas = 0;
+    long medirInforme = 0;
+    const char* archivoLotes = NULL;
+    bool persistir = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sync=siempre") == 0) {
+            politicaSync = SYNC_SIEMPRE;
+        } else if (strcmp(argv[i], "--sync=nunca") == 0) {
+            politicaSync = SYNC_NUNCA;
+        } else if (strncmp(argv[i], "--sync=grupo", 12) == 0) {
+            politicaSync = SYNC_GRUPO;
+            if (argv[i][12] == ':') intervaloSyncMs = atoi(argv[i] + 13);
+        } else if (strcmp(argv[i], "--bench-wal") == 0) {
+            medirAltas = 10000;
+            if (i + 1 < argc && atol(argv[i + 1]) > 0) medirAltas = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-consanguinidad") == 0) {
+            medirConsang = 200000;
+            if (i + 1 < argc && atol(argv[i + 1]) > 0) medirConsang = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-lectores") == 0) {
+            medirLecturas = 1000000;
+            if (i + 1 < argc && atol(argv[i + 1]) > 0) medirLecturas = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--bench-reduccion") == 0) {
+            medirInforme = 10000000;
+            if (i + 1 < argc && atol(argv[i + 1]) > 0) medirInforme = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            archivoLotes = "-";
+            if (i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) archivoLotes = argv[++i];
+        } else if (strcmp(argv[i], "--sin-persistencia") == 0) {
+            persistir = false;
+        } else {
+            cerr << "Opcion desconocida: " << argv[i] << "\n";
+            return 1;
+        }
+    }
+    
+    if (medirAltas > 0) {
+        medirRegistro(medirAltas);
+        return 0;
+    }
+    if (medirConsang > 0) {
+        medirConsanguinidad(medirConsang, 50);
+        return 0;
+    }
+    if (medirLecturas > 0) {
+        medirLectores(medirLecturas);
+        return 0;
+    }
+    if (medirInforme > 0) {
+        medirReduccion(medirInforme);
+        return 0;
+    }
+    if (archivoLotes != NULL) {
+        return ejecutarLotes(archivoLotes, persistir) == 0 ? 0 : 1;
+    }
     menu();
     return 0;
 }
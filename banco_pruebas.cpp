@@ -0,0 +1,533 @@
+// =============================================================================
+// BANCO DE PRUEBAS DEL RBOL GENEALGICO
+// Mide las operaciones de una de las tres versiones del programa y escribe el
+// resultado en JSON, para comparar versiones y detectar regresiones. El
+// fuente de la versin se incluye entero (su main queda renombrado), as se
+// mide exactamente el cdigo que se entrega.
+//
+// Compilacin, una vez por versin:
+//   g++ -std=c++11 -O2 -pthread -DBANCO_V03 -o banco_v03 banco_pruebas.cpp
+//   g++ -std=c++11 -O2 -DBANCO_V02 -o banco_v02 banco_pruebas.cpp
+//   g++ -std=c++11 -O2 -DBANCO_ORIGINAL -o banco_original banco_pruebas.cpp
+//
+// Uso: banco_xxx [personas] [archivo.json]
+//   personas      tamao del rbol de las pruebas (10000 por omisin; la V02
+//                 es cuadrtica con IDs secuenciales, no conviene pasar de 20000)
+//   archivo.json  destino del informe (por omisin, la salida estndar)
+// Lo que imprimen las funciones medidas se descarta en /dev/null.
+//
+// Casos (los que la versin no tiene se omiten):
+//   insertar|buscar|eliminar/secuencial|aleatorio|sesgado
+//       secuencial: IDs 1..n; aleatorio: permutacin uniforme; sesgado: el
+//       10% de IDs ms nuevos primero, y buscar pide esos IDs el 90% de las
+//       veces (el patrn de una interfaz que mira lo ltimo que se carg)
+//   recorrido/<funcin>       rbol completo de n personas con IDs secuenciales
+//                             (el original no mide porNiveles: su cola de
+//                             100 nodos descarta el resto del rbol)
+//   eliminar/apellido_comun   baja en orden aleatorio de n personas con
+//                             apellidos sesgados: la mitad se llama Garca y
+//                             el resto sigue una ley de Zipf (el caso que
+//                             castiga a un ndice de nombres lineal por clave)
+//   ancestros/profundo        cadena de padres de n/5 generaciones
+//   ancestros/colapsado       una pareja de hermanos por generacin: 2g
+//                             ancestros distintos pero 2^g caminos
+//   balancearArbol            reconstruccin completa sobre n personas
+//
+// Cada caso informa ns_por_op (total / operaciones), p50_lote_ns y
+// p99_lote_ns, que son percentiles del promedio por operacin de cada lote de
+// ops_por_muestra operaciones y no de operaciones sueltas (por debajo de unos
+// cientos de ns el reloj no alcanza para medirlas una a una; con
+// ops_por_muestra = 1 s son por operacin), y asignaciones_por_op (llamadas
+// a operator new).
+// =============================================================================
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <fcntl.h>
+#include <unistd.h>
+
+#if defined(BANCO_V03)
+#define FUENTE_BANCO "arbol_V03.cpp"
+#elif defined(BANCO_V02)
+#define FUENTE_BANCO "arbol_V02.cpp"
+#else
+#ifndef BANCO_ORIGINAL
+#define BANCO_ORIGINAL
+#endif
+#define FUENTE_BANCO "Arbol Genealogico.cpp"
+#endif
+
+#define main mainArbol
+#include FUENTE_BANCO
+#undef main
+
+// =============================================================================
+// CONTEO DE ASIGNACIONES
+// Todas las versiones piden memoria con new, as que alcanza con reemplazar
+// los operadores globales. Las pruebas corren en un solo hilo.
+// =============================================================================
+long asignacionesBanco = 0;
+
+void* reservarBanco(size_t tamano) {
+    asignacionesBanco++;
+    void* p = malloc(tamano > 0 ? tamano : 1);
+    if (p == NULL) throw std::bad_alloc();
+    return p;
+}
+
+// Sin inline: si no, GCC ve el malloc y el free de a pares y avisa de
+// new/delete mezclados donde no los hay.
+__attribute__((noinline)) void* operator new(size_t tamano) { return reservarBanco(tamano); }
+__attribute__((noinline)) void* operator new[](size_t tamano) { return reservarBanco(tamano); }
+__attribute__((noinline)) void operator delete(void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept { free(p); }
+__attribute__((noinline)) void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// =============================================================================
+// ADAPTADORES POR VERSIN
+// Cada versin expone las mismas operaciones con otra firma. En la V03 se
+// usan los puntos de entrada del men (agregarPersona, buscarPorID y
+// quitarPersona), que adems mantienen los ndices secundarios.
+// =============================================================================
+// Nombres de 16 a 26 letras (ms que el bfer corto de std::string, como
+// los nombres reales), combinados para que no se repitan todos.
+const char* nombresDePila[16] = {"Juan", "Maria", "Jose", "Ana", "Luis", "Carmen", "Pedro", "Rosa",
+                                 "Carlos", "Lucia", "Jorge", "Elena", "Miguel", "Sofia", "Diego", "Laura"};
+const char* apellidosBanco[12] = {"Garcia", "Lopez", "Perez", "Gonzalez", "Rodriguez", "Fernandez",
+                                  "Martinez", "Sanchez", "Romero", "Diaz", "Torres", "Ruiz"};
+const int NOMBRES_DISTINTOS = 16 * 12 * 12;
+char nombresBanco[NOMBRES_DISTINTOS][32];
+
+void prepararNombres() {
+    for (int i = 0; i < NOMBRES_DISTINTOS; i++) {
+        snprintf(nombresBanco[i], sizeof(nombresBanco[i]), "%s %s %s", nombresDePila[i % 16],
+                 apellidosBanco[i / 16 % 12], apellidosBanco[i / 192]);
+    }
+}
+
+// Misma tabla con apellidos sesgados, como en un pueblo o una familia
+// extensa: la mitad de las personas tiene Garca de primer apellido y el
+// resto se reparte con peso 1/k entre los dems; el segundo apellido sigue
+// la misma distribucin, as "Garcia Garcia" es la clave ms repetida.
+char nombresSesgados[NOMBRES_DISTINTOS][32];
+bool apellidosSesgados = false;
+
+const char* apellidoSesgado(int k, int total) {
+    if (k < total / 2) return apellidosBanco[0];
+    double suma = 0, pesos[12];
+    for (int a = 1; a < 12; a++) suma += pesos[a] = 1.0 / a;
+    double x = (double)(k - total / 2) / (total - total / 2) * suma;
+    for (int a = 1; a < 11; a++) {
+        if (x < pesos[a]) return apellidosBanco[a];
+        x -= pesos[a];
+    }
+    return apellidosBanco[11];
+}
+
+void prepararNombresSesgados() {
+    const int combinaciones = NOMBRES_DISTINTOS / 16;
+    for (int i = 0; i < NOMBRES_DISTINTOS; i++) {
+        int k = i / 16;
+        snprintf(nombresSesgados[i], sizeof(nombresSesgados[i]), "%s %s %s", nombresDePila[i % 16],
+                 apellidoSesgado(k, combinaciones),
+                 apellidoSesgado((k * 37 + 11) % combinaciones, combinaciones));
+    }
+}
+
+const char* nombreDe(int id) {
+    return (apellidosSesgados ? nombresSesgados : nombresBanco)[id % NOMBRES_DISTINTOS];
+}
+
+Persona* arbolBanco = NULL;
+
+#if defined(BANCO_V03)
+void bancoInsertar(int id, Persona* padre, Persona* madre) {
+    const char* nombre = nombreDe(id);
+    agregarPersona(arbolBanco, id, guardarCadena(nombre, (int)strlen(nombre)),
+                   empaquetarFecha(1, 1, 1950), padre, madre);
+}
+
+Persona* bancoBuscar(int id) {
+    return buscarPorID(id);
+}
+
+void bancoEliminar(int id) {
+    quitarPersona(arbolBanco, id);
+}
+
+void bancoVaciar() {
+    vaciarBase(arbolBanco);
+}
+
+void bancoPreorden(Persona* raiz) { preorden(raiz); }
+void bancoInorden(Persona* raiz) { inorden(raiz); }
+void bancoInordenMorris(Persona* raiz) { inordenMorris(raiz); }
+void bancoPostorden(Persona* raiz) { postorden(raiz); }
+void bancoPorNiveles(Persona* raiz) { porNiveles(raiz); }
+void bancoAncestros(Persona* p) { mostrarAncestros(p); }
+#else
+void bancoInsertar(int id, Persona* padre, Persona* madre) {
+    insertar(arbolBanco, id, nombreDe(id), "01/01/1950", padre, madre);
+}
+
+Persona* bancoBuscar(int id) {
+    return buscar(arbolBanco, id);
+}
+
+void bancoEliminar(int id) {
+    arbolBanco = eliminar(arbolBanco, id);
+}
+
+// Sacar siempre la raz es O(1) en el rbol degenerado de la V02.
+void bancoVaciar() {
+    while (arbolBanco != NULL) arbolBanco = eliminar(arbolBanco, arbolBanco->id);
+}
+
+void bancoDescendientes(Persona* raiz) { mostrarDescendientes(raiz); }
+void bancoAncestros(Persona* p) { mostrarAncestros(p); }
+#if defined(BANCO_ORIGINAL)
+void bancoInorden(Persona* raiz) { inorden(raiz); }
+#endif
+#endif
+
+struct RecorridoBanco {
+    const char* nombre;
+    void (*recorrer)(Persona*);
+};
+
+#if defined(BANCO_V03)
+const RecorridoBanco RECORRIDOS_BANCO[] = {
+    {"recorrido/preorden", bancoPreorden}, {"recorrido/inorden", bancoInorden},
+    {"recorrido/inordenMorris", bancoInordenMorris}, {"recorrido/postorden", bancoPostorden},
+    {"recorrido/porNiveles", bancoPorNiveles}
+};
+#elif defined(BANCO_V02)
+// La V02 no tiene recorridos: su nico paseo por todo el rbol es
+// mostrarDescendientes, que sigue los enlaces del ABB.
+const RecorridoBanco RECORRIDOS_BANCO[] = {
+    {"recorrido/mostrarDescendientes", bancoDescendientes}
+};
+#else
+// porNiveles del original encola en un arreglo fijo de MAX_NODOS (100) y
+// descarta el resto sin avisar: con n personas visitara unas 100, as que
+// no se mide.
+const RecorridoBanco RECORRIDOS_BANCO[] = {
+    {"recorrido/inorden", bancoInorden}, {"recorrido/mostrarDescendientes", bancoDescendientes}
+};
+#endif
+const int CANTIDAD_RECORRIDOS = (int)(sizeof(RECORRIDOS_BANCO) / sizeof(RECORRIDOS_BANCO[0]));
+
+// =============================================================================
+// MEDICIN
+// Las muestras se guardan con malloc para no contarse como asignaciones de
+// la operacin medida.
+// =============================================================================
+struct MedicionBanco {
+    const char* caso;
+    long personas;
+    long opsPorMuestra;
+    long operaciones;
+    long asignaciones;                  // Valor del contador al empezar
+    double totalNs;
+    double* muestras;                   // ns por operacin de cada muestra
+    long cantidad;
+    long capacidad;
+};
+
+FILE* informeBanco = NULL;
+bool primerCasoBanco = true;
+volatile long sumideroBanco = 0;        // Evita que se descarten las bsquedas
+
+typedef chrono::steady_clock::time_point InstanteBanco;
+
+void empezarMedicion(MedicionBanco &m, const char* caso, long personas, long opsPorMuestra, long muestras) {
+    m.caso = caso;
+    m.personas = personas;
+    m.opsPorMuestra = opsPorMuestra;
+    m.operaciones = 0;
+    m.totalNs = 0;
+    m.capacidad = muestras > 0 ? muestras : 1;
+    m.muestras = (double*)malloc(m.capacidad * sizeof(double));
+    m.cantidad = 0;
+    m.asignaciones = asignacionesBanco;
+}
+
+void anotarMuestra(MedicionBanco &m, InstanteBanco inicio, long operaciones) {
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - inicio).count();
+    if (m.cantidad == m.capacidad) {
+        m.capacidad *= 2;
+        m.muestras = (double*)realloc(m.muestras, m.capacidad * sizeof(double));
+    }
+    m.muestras[m.cantidad++] = ns / operaciones;
+    m.totalNs += ns;
+    m.operaciones += operaciones;
+}
+
+int compararMuestras(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+double percentil(const MedicionBanco &m, double p) {
+    if (m.cantidad == 0) return 0;
+    return m.muestras[(long)(p * (m.cantidad - 1) + 0.5)];
+}
+
+// Escribe el caso como un objeto del arreglo "casos" y libera las muestras.
+void terminarMedicion(MedicionBanco &m) {
+    long asignaciones = asignacionesBanco - m.asignaciones;
+    qsort(m.muestras, m.cantidad, sizeof(double), compararMuestras);
+    long ops = m.operaciones > 0 ? m.operaciones : 1;
+    fprintf(informeBanco,
+            "%s\n    {\"caso\": \"%s\", \"personas\": %ld, \"operaciones\": %ld, \"ops_por_muestra\": %ld, "
+            "\"ns_por_op\": %.1f, \"p50_lote_ns\": %.1f, \"p99_lote_ns\": %.1f, \"asignaciones_por_op\": %.3f}",
+            primerCasoBanco ? "" : ",", m.caso, m.personas, m.operaciones, m.opsPorMuestra,
+            m.totalNs / ops, percentil(m, 0.50), percentil(m, 0.99), (double)asignaciones / ops);
+    primerCasoBanco = false;
+    fflush(informeBanco);
+    free(m.muestras);
+    m.muestras = NULL;
+}
+
+// =============================================================================
+// RDENES DE IDs
+// =============================================================================
+enum OrdenBanco { ORDEN_SECUENCIAL, ORDEN_ALEATORIO, ORDEN_SESGADO };
+
+const char* NOMBRES_ORDEN[] = {"secuencial", "aleatorio", "sesgado"};
+
+unsigned int semillaBanco = 12345;
+
+unsigned int aleatorioBanco() {
+    semillaBanco = semillaBanco * 1103515245u + 12345u;
+    return semillaBanco >> 8;
+}
+
+void mezclar(int* ids, long desde, long hasta) {
+    for (long i = hasta - 1; i > desde; i--) {
+        long j = desde + (long)(((unsigned long)aleatorioBanco() << 16 ^ aleatorioBanco()) % (i - desde + 1));
+        int t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+}
+
+// Permutacin de 1..n en el orden pedido (para altas y bajas).
+void ordenarIDs(int* ids, long n, OrdenBanco orden) {
+    for (long i = 0; i < n; i++) ids[i] = (int)(i + 1);
+    if (orden == ORDEN_ALEATORIO) {
+        mezclar(ids, 0, n);
+    } else if (orden == ORDEN_SESGADO) {
+        long calientes = n / 10;
+        for (long i = 0; i < calientes; i++) ids[i] = (int)(n - i);
+        for (long i = calientes; i < n; i++) ids[i] = (int)(i - calientes + 1);
+        mezclar(ids, 0, calientes);
+        mezclar(ids, calientes, n);
+    }
+}
+
+// IDs a buscar (con repeticin en el orden aleatorio y el sesgado).
+void sortearBusquedas(int* ids, long n, OrdenBanco orden) {
+    long calientes = n / 10 > 0 ? n / 10 : 1;
+    for (long i = 0; i < n; i++) {
+        if (orden == ORDEN_SECUENCIAL) {
+            ids[i] = (int)(i + 1);
+        } else if (orden == ORDEN_ALEATORIO || aleatorioBanco() % 10 == 0) {
+            ids[i] = (int)(1 + aleatorioBanco() % n);
+        } else {
+            ids[i] = (int)(n - aleatorioBanco() % calientes);
+        }
+    }
+}
+
+// =============================================================================
+// CASOS
+// =============================================================================
+const long LOTE_PUNTUAL = 16;           // Operaciones por muestra en altas, bajas y bsquedas
+
+char casoBanco[64];
+
+const char* nombreCaso(const char* operacion, OrdenBanco orden) {
+    snprintf(casoBanco, sizeof(casoBanco), "%s/%s", operacion, NOMBRES_ORDEN[orden]);
+    return casoBanco;
+}
+
+// Alta de n personas en el orden dado, bsqueda de n IDs y baja de todas.
+void medirOperaciones(long n, OrdenBanco orden) {
+    int* ids = (int*)malloc(n * sizeof(int));
+    MedicionBanco m;
+
+    ordenarIDs(ids, n, orden);
+    empezarMedicion(m, nombreCaso("insertar", orden), n, LOTE_PUNTUAL, n / LOTE_PUNTUAL + 1);
+    for (long i = 0; i < n; i += LOTE_PUNTUAL) {
+        long hasta = i + LOTE_PUNTUAL < n ? i + LOTE_PUNTUAL : n;
+        InstanteBanco inicio = chrono::steady_clock::now();
+        for (long k = i; k < hasta; k++) bancoInsertar(ids[k], NULL, NULL);
+        anotarMuestra(m, inicio, hasta - i);
+    }
+    terminarMedicion(m);
+
+    sortearBusquedas(ids, n, orden);
+    empezarMedicion(m, nombreCaso("buscar", orden), n, LOTE_PUNTUAL, n / LOTE_PUNTUAL + 1);
+    for (long i = 0; i < n; i += LOTE_PUNTUAL) {
+        long hasta = i + LOTE_PUNTUAL < n ? i + LOTE_PUNTUAL : n;
+        long encontrados = 0;
+        InstanteBanco inicio = chrono::steady_clock::now();
+        for (long k = i; k < hasta; k++) encontrados += bancoBuscar(ids[k]) != NULL;
+        anotarMuestra(m, inicio, hasta - i);
+        sumideroBanco += encontrados;
+    }
+    terminarMedicion(m);
+
+    ordenarIDs(ids, n, orden);
+    empezarMedicion(m, nombreCaso("eliminar", orden), n, LOTE_PUNTUAL, n / LOTE_PUNTUAL + 1);
+    for (long i = 0; i < n; i += LOTE_PUNTUAL) {
+        long hasta = i + LOTE_PUNTUAL < n ? i + LOTE_PUNTUAL : n;
+        InstanteBanco inicio = chrono::steady_clock::now();
+        for (long k = i; k < hasta; k++) bancoEliminar(ids[k]);
+        anotarMuestra(m, inicio, hasta - i);
+    }
+    terminarMedicion(m);
+
+    bancoVaciar();
+    free(ids);
+}
+
+void construirSecuencial(long n) {
+    for (long i = 1; i <= n; i++) bancoInsertar((int)i, NULL, NULL);
+}
+
+// Baja en orden aleatorio de n personas que comparten pocos apellidos.
+void medirEliminarApellidos(long n) {
+    int* ids = (int*)malloc(n * sizeof(int));
+    MedicionBanco m;
+
+    apellidosSesgados = true;
+    construirSecuencial(n);
+    ordenarIDs(ids, n, ORDEN_ALEATORIO);
+    empezarMedicion(m, "eliminar/apellido_comun", n, LOTE_PUNTUAL, n / LOTE_PUNTUAL + 1);
+    for (long i = 0; i < n; i += LOTE_PUNTUAL) {
+        long hasta = i + LOTE_PUNTUAL < n ? i + LOTE_PUNTUAL : n;
+        InstanteBanco inicio = chrono::steady_clock::now();
+        for (long k = i; k < hasta; k++) bancoEliminar(ids[k]);
+        anotarMuestra(m, inicio, hasta - i);
+    }
+    terminarMedicion(m);
+    apellidosSesgados = false;
+
+    bancoVaciar();
+    free(ids);
+}
+
+void medirRecorridos(long n, int repeticiones) {
+    construirSecuencial(n);
+    for (int r = 0; r < CANTIDAD_RECORRIDOS; r++) {
+        MedicionBanco m;
+        empezarMedicion(m, RECORRIDOS_BANCO[r].nombre, n, 1, repeticiones);
+        for (int k = 0; k < repeticiones; k++) {
+            InstanteBanco inicio = chrono::steady_clock::now();
+            RECORRIDOS_BANCO[r].recorrer(arbolBanco);
+            cout.flush();
+            anotarMuestra(m, inicio, 1);
+        }
+        terminarMedicion(m);
+    }
+    bancoVaciar();
+}
+
+// Pedigr profundo: la persona 2g+2 es hija de la 2g (la anterior de la
+// cadena) y de la 2g+1 (una fundadora sin padres).
+Persona* pedigriProfundo(int generaciones) {
+    bancoInsertar(2, NULL, NULL);
+    for (int g = 1; g < generaciones; g++) {
+        bancoInsertar(2 * g + 1, NULL, NULL);
+        bancoInsertar(2 * g + 2, bancoBuscar(2 * g), bancoBuscar(2 * g + 1));
+    }
+    return bancoBuscar(2 * generaciones);
+}
+
+// Pedigr colapsado: cada generacin es una pareja de hermanos, hijos de la
+// pareja anterior (personas 2g+1 y 2g+2).
+Persona* pedigriColapsado(int generaciones) {
+    bancoInsertar(1, NULL, NULL);
+    bancoInsertar(2, NULL, NULL);
+    for (int g = 1; g <= generaciones; g++) {
+        Persona* padre = bancoBuscar(2 * g - 1);
+        Persona* madre = bancoBuscar(2 * g);
+        bancoInsertar(2 * g + 1, padre, madre);
+        bancoInsertar(2 * g + 2, padre, madre);
+    }
+    return bancoBuscar(2 * generaciones + 1);
+}
+
+void medirAncestros(const char* caso, Persona* persona, long personas, int repeticiones) {
+    MedicionBanco m;
+    empezarMedicion(m, caso, personas, 1, repeticiones);
+    for (int k = 0; k < repeticiones; k++) {
+        InstanteBanco inicio = chrono::steady_clock::now();
+        bancoAncestros(persona);
+        cout.flush();
+        anotarMuestra(m, inicio, 1);
+    }
+    terminarMedicion(m);
+    bancoVaciar();
+}
+
+#if defined(BANCO_ORIGINAL)
+void medirBalanceo(long n, int repeticiones) {
+    construirSecuencial(n);
+    MedicionBanco m;
+    empezarMedicion(m, "balancearArbol", n, 1, repeticiones);
+    for (int k = 0; k < repeticiones; k++) {
+        InstanteBanco inicio = chrono::steady_clock::now();
+        balancearArbol(arbolBanco);
+        anotarMuestra(m, inicio, 1);
+    }
+    terminarMedicion(m);
+    bancoVaciar();
+}
+#endif
+
+// =============================================================================
+// FUNCIN: main
+// =============================================================================
+int main(int argc, char* argv[]) {
+    long n = argc > 1 ? atol(argv[1]) : 10000;
+    if (n < 10) {
+        fprintf(stderr, "Uso: %s [personas >= 10] [archivo.json]\n", argv[0]);
+        return 1;
+    }
+    informeBanco = argc > 2 ? fopen(argv[2], "w") : fdopen(dup(1), "w");
+    if (informeBanco == NULL) {
+        perror(argc > 2 ? argv[2] : "stdout");
+        return 1;
+    }
+    // Todo lo que imprimen las operaciones va a /dev/null.
+    int nulo = open("/dev/null", O_WRONLY);
+    if (nulo >= 0) {
+        dup2(nulo, 1);
+        close(nulo);
+    }
+
+    prepararNombres();
+    prepararNombresSesgados();
+    fprintf(informeBanco, "{\n  \"version\": \"%s\",\n  \"personas\": %ld,\n  \"casos\": [", FUENTE_BANCO, n);
+    for (int orden = ORDEN_SECUENCIAL; orden <= ORDEN_SESGADO; orden++) {
+        medirOperaciones(n, (OrdenBanco)orden);
+    }
+    medirEliminarApellidos(n);
+    medirRecorridos(n, 10);
+    int generaciones = (int)(n / 5);
+    medirAncestros("ancestros/profundo", pedigriProfundo(generaciones), 2L * generaciones, 20);
+    medirAncestros("ancestros/colapsado", pedigriColapsado(16), 2L * 16 + 2, 5);
+#if defined(BANCO_ORIGINAL)
+    medirBalanceo(n, 20);
+#endif
+    fprintf(informeBanco, "\n  ]\n}\n");
+    fclose(informeBanco);
+    return 0;
+}